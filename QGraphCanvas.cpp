@@ -26,6 +26,8 @@
 #include "QGraphNode.h"
 #include "QGraphEdge.h"
 
+#include <QBuffer>
+#include <QFile>
 #include <QPainter>
 #include <QDebug>
 
@@ -48,16 +50,6 @@ QGraphCanvas::QGraphCanvas(const QString &name,
     : QGraphicsScene( parent )
     , d_ptr( new QGraphCanvasPrivate( name, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, this ) )
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, this, &QGraphCanvas::handleLayoutUdated );
-#else
-    connect( this, SIGNAL(layoutUpdated()), this, SLOT(handleLayoutUdated()) );
-#endif
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::selectionChanged, this, &QGraphCanvas::handleSelectionChanged );
-#else
-    connect( this, SIGNAL(selectionChanged()), this, SLOT(handleSelectionChanged()) );
-#endif
 }
 
 /**
@@ -79,16 +71,37 @@ QGraphCanvas::QGraphCanvas(const char *data,
     : QGraphicsScene( parent )
     , d_ptr( new QGraphCanvasPrivate( data, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, this ) )
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, this, &QGraphCanvas::handleLayoutUdated );
-#else
-    connect( this, SIGNAL(layoutUpdated()), this, SLOT(handleLayoutUdated()) );
-#endif
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::selectionChanged, this, &QGraphCanvas::handleSelectionChanged );
-#else
-    connect( this, SIGNAL(selectionChanged()), this, SLOT(handleSelectionChanged()) );
-#endif
+    Q_D(QGraphCanvas);
+
+    // the items reach the canvas through d_ptr when added to the scene so they are created once it is set
+    d->createGraphItems();
+}
+
+/**
+ * @brief QGraphCanvas::QGraphCanvas
+ * @param device - the device from which the DOT formatted graph is read
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @param parent - the parent widget
+ *
+ * Constructs an QGraphCanvas instance of the given parent from a DOT formatted graph read from the device.
+ * The graph is streamed to the libcgraph parser line by line, so the DOT text is never held in memory as a
+ * whole.  A QFile is memory-mapped instead of being read when possible.  The device is opened for reading if
+ * it is not open yet.  The graph nodes and edges will be created automatically.
+ */
+QGraphCanvas::QGraphCanvas(QIODevice *device,
+                           const NameValueList& graphAttributeSettings,
+                           const NameValueList& nodeAttributeSettings,
+                           const NameValueList& edgeAttributeSettings,
+                           QObject *parent)
+    : QGraphicsScene( parent )
+    , d_ptr( new QGraphCanvasPrivate( device, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, this ) )
+{
+    Q_D(QGraphCanvas);
+
+    // the items reach the canvas through d_ptr when added to the scene so they are created once it is set
+    d->createGraphItems();
 }
 
 /**
@@ -110,16 +123,6 @@ QGraphCanvas::QGraphCanvas(const QString &name, const QRectF &sceneRect,
     : QGraphicsScene( sceneRect, parent )
     , d_ptr( new QGraphCanvasPrivate( name, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, this ) )
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, this, &QGraphCanvas::handleLayoutUdated );
-#else
-    connect( this, SIGNAL(layoutUpdated()), this, SLOT(handleLayoutUdated()) );
-#endif
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::selectionChanged, this, &QGraphCanvas::handleSelectionChanged );
-#else
-    connect( this, SIGNAL(selectionChanged()), this, SLOT(handleSelectionChanged()) );
-#endif
 }
 
 /**
@@ -144,16 +147,6 @@ QGraphCanvas::QGraphCanvas(const QString &name, qreal x, qreal y, qreal width, q
     : QGraphicsScene( x, y, width, height, parent )
     , d_ptr( new QGraphCanvasPrivate( name, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, this ) )
 {
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, this, &QGraphCanvas::handleLayoutUdated );
-#else
-    connect( this, SIGNAL(layoutUpdated()), this, SLOT(handleLayoutUdated()) );
-#endif
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::selectionChanged, this, &QGraphCanvas::handleSelectionChanged );
-#else
-    connect( this, SIGNAL(selectionChanged()), this, SLOT(handleSelectionChanged()) );
-#endif
 }
 
 /**
@@ -167,6 +160,188 @@ QGraphCanvas::~QGraphCanvas()
     delete d;
 }
 
+/**
+ * @brief QGraphCanvas::fromFile
+ * @param fileName - the name of the DOT file
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @param parent - the parent widget
+ * @return - the new QGraphCanvas instance (NULL if the file cannot be opened)
+ *
+ * Constructs an QGraphCanvas instance of the given parent from a DOT file.  The file is memory-mapped when possible.
+ */
+QGraphCanvas* QGraphCanvas::fromFile(const QString &fileName,
+                                     const NameValueList& graphAttributeSettings,
+                                     const NameValueList& nodeAttributeSettings,
+                                     const NameValueList& edgeAttributeSettings,
+                                     QObject *parent)
+{
+    QFile file( fileName );
+
+    if ( ! file.open( QIODevice::ReadOnly ) ) {
+        qCritical() << "ERROR: Unable to open DOT file '" << fileName << "'";
+        return Q_NULLPTR;
+    }
+
+    return new QGraphCanvas( &file, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings, parent );
+}
+
+/**
+ * @brief QGraphCanvas::loadGraphAsync
+ * @param fileName - the name of the DOT file
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ *
+ * Loads the graph from a DOT file without blocking the GUI thread.  The file is parsed on a worker thread and the graph
+ * items are then created on the GUI thread in short time slices.  The loadProgress() signal reports the number of nodes
+ * whose items have been created and the loadFinished() signal is emitted when the load completes.  When the file has been
+ * parsed the current graph and all its items are replaced by the loaded graph.  A load still in progress is superseded.
+ * If the superseded load is already creating its items, its partly itemized graph is cleared as by clearGraph().
+ */
+void QGraphCanvas::loadGraphAsync(const QString &fileName,
+                                  const NameValueList& graphAttributeSettings,
+                                  const NameValueList& nodeAttributeSettings,
+                                  const NameValueList& edgeAttributeSettings)
+{
+    Q_D(QGraphCanvas);
+
+    QGraphCanvasPrivate::LoadRequest request;
+    request.fileName = fileName;
+
+    d->loadGraphAsync( request, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+}
+
+/**
+ * @brief QGraphCanvas::loadGraphAsync
+ * @param data - the DOT formatted graph
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ *
+ * Loads the graph from DOT formatted data without blocking the GUI thread.  See the file name overload for details.
+ */
+void QGraphCanvas::loadGraphAsync(const QByteArray &data,
+                                  const NameValueList& graphAttributeSettings,
+                                  const NameValueList& nodeAttributeSettings,
+                                  const NameValueList& edgeAttributeSettings)
+{
+    Q_D(QGraphCanvas);
+
+    QGraphCanvasPrivate::LoadRequest request;
+    request.data = data;
+
+    d->loadGraphAsync( request, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+}
+
+/**
+ * @brief QGraphCanvas::cancelLoad
+ *
+ * Cancels the asynchronous load in progress, if any, and emits the loadFinished() signal.  A graph still being parsed
+ * is discarded and the current graph is kept.  A parsed graph whose items are being created has already replaced the
+ * current graph, so the graph is cleared as by clearGraph() in that case.
+ */
+void QGraphCanvas::cancelLoad()
+{
+    Q_D(QGraphCanvas);
+    d->cancelLoad();
+}
+
+/**
+ * @brief QGraphCanvas::isLoading
+ * @return - whether an asynchronous load is in progress
+ */
+bool QGraphCanvas::isLoading() const
+{
+    Q_D(const QGraphCanvas);
+    return d->isLoading();
+}
+
+/**
+ * @brief QGraphCanvas::clearGraph
+ *
+ * Destroys all graph nodes and edges and frees the graph and its layout.  The canvas continues with an empty graph
+ * of the same name and kind which keeps the default attribute values.
+ */
+void QGraphCanvas::clearGraph()
+{
+    Q_D(QGraphCanvas);
+    d->clearGraph();
+}
+
+/**
+ * @brief QGraphCanvas::reload
+ * @param device - the device from which the DOT formatted graph is read
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @return - whether the graph was read successfully
+ *
+ * Replaces the graph and all its nodes and edges by the DOT formatted graph read from the device, reusing the canvas.
+ * The previous graph and its layout are freed.  The current graph is kept if the new graph cannot be read.
+ */
+bool QGraphCanvas::reload(QIODevice *device,
+                          const NameValueList& graphAttributeSettings,
+                          const NameValueList& nodeAttributeSettings,
+                          const NameValueList& edgeAttributeSettings)
+{
+    Q_D(QGraphCanvas);
+    return d->reloadGraph( device, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+}
+
+/**
+ * @brief QGraphCanvas::reload
+ * @param data - the DOT formatted graph
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @return - whether the graph was read successfully
+ *
+ * Replaces the graph and all its nodes and edges by the DOT formatted graph, reusing the canvas.
+ */
+bool QGraphCanvas::reload(const QByteArray &data,
+                          const NameValueList& graphAttributeSettings,
+                          const NameValueList& nodeAttributeSettings,
+                          const NameValueList& edgeAttributeSettings)
+{
+    Q_D(QGraphCanvas);
+
+    QBuffer buffer;
+    buffer.setData( data );
+
+    return d->reloadGraph( &buffer, graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+}
+
+/**
+ * @brief QGraphCanvas::saveSnapshot
+ * @param fileName - the name of the snapshot file
+ * @return - whether the snapshot was saved successfully
+ *
+ * Saves the graph with all its attributes and subgraphs together with the current layout of its nodes and edges
+ * to a versioned binary snapshot file.  No snapshot is saved while nodes are hidden by collapsed nodes or clusters.
+ */
+bool QGraphCanvas::saveSnapshot(const QString &fileName) const
+{
+    Q_D(const QGraphCanvas);
+    return d->saveSnapshot( fileName );
+}
+
+/**
+ * @brief QGraphCanvas::loadSnapshot
+ * @param fileName - the name of the snapshot file
+ * @return - whether the snapshot was loaded successfully
+ *
+ * Replaces the current graph and all its items by the graph of a snapshot file saved by saveSnapshot().  The saved
+ * layout is applied as is, so neither the DOT parser nor a layout engine is run.  The file is memory-mapped when
+ * possible.  The layoutUpdated() signal is emitted if the snapshot contains a layout.
+ */
+bool QGraphCanvas::loadSnapshot(const QString &fileName)
+{
+    Q_D(QGraphCanvas);
+    return d->loadSnapshot( fileName );
+}
+
 /**
  * @brief QGraphCanvas::updateLayout
  *
@@ -178,6 +353,75 @@ void QGraphCanvas::updateLayout()
     d->updateLayout();
 }
 
+/**
+ * @brief QGraphCanvas::updateLayoutAsync
+ *
+ * Updates the layout of the graph canvas on a worker thread.  The layoutUpdated() signal is emitted
+ * once the new layout has been applied to the graph nodes and edges.  A pending layout is discarded
+ * when superseded by a newer call to updateLayout() or updateLayoutAsync().  This function does not wait for a
+ * layout already running on a worker thread.  Such a layout cannot be interrupted, so a superseded layout that has
+ * started still runs to completion before its result is discarded.  The functions using the Graphviz library on the
+ * GUI thread, such as updateLayout(), collapseCluster(), expandCluster() and the destructor, wait for it to finish.
+ */
+void QGraphCanvas::updateLayoutAsync()
+{
+    Q_D(QGraphCanvas);
+    d->updateLayoutAsync();
+}
+
+/**
+ * @brief QGraphCanvas::updateLayoutIncremental
+ *
+ * Lays out only the nodes and edges added since the last layout.  The positions of the nodes already laid out are
+ * preserved and the new nodes are placed near the nodes they are connected to.  This is intended for interactively
+ * expanding a large graph.  If the graph has not been laid out yet a full layout is done instead.
+ */
+void QGraphCanvas::updateLayoutIncremental()
+{
+    Q_D(QGraphCanvas);
+    d->updateLayoutIncremental();
+}
+
+/**
+ * @brief QGraphCanvas::setLayoutEngine
+ * @param engine - the Graphviz layout engine
+ *
+ * Sets the Graphviz layout engine used by updateLayout() and updateLayoutAsync().  The default is the "dot" engine.
+ */
+void QGraphCanvas::setLayoutEngine(LayoutEngine engine)
+{
+    Q_D(QGraphCanvas);
+    d->setLayoutEngine( engine );
+}
+
+/**
+ * @brief QGraphCanvas::layoutEngine
+ * @return - the Graphviz layout engine
+ *
+ * Returns the Graphviz layout engine used by updateLayout() and updateLayoutAsync().
+ */
+QGraphCanvas::LayoutEngine QGraphCanvas::layoutEngine() const
+{
+    Q_D(const QGraphCanvas);
+    return d->layoutEngine();
+}
+
+/**
+ * @brief QGraphCanvas::setScalableLayoutEngine
+ * @param engine - the Graphviz layout engine used for large graphs (for instance QGraphCanvas::SfdpEngine)
+ * @param nodeThreshold - the number of nodes above which the engine is used (zero to ignore the number of nodes)
+ * @param edgeThreshold - the number of edges above which the engine is used (zero to ignore the number of edges)
+ *
+ * Sets the policy to automatically switch to a layout engine scaling better than the engine set with setLayoutEngine()
+ * when the graph has more nodes or edges than the given thresholds.  Passing zero for both thresholds disables the policy,
+ * which is the default.
+ */
+void QGraphCanvas::setScalableLayoutEngine(LayoutEngine engine, int nodeThreshold, int edgeThreshold)
+{
+    Q_D(QGraphCanvas);
+    d->setScalableLayoutEngine( engine, nodeThreshold, edgeThreshold );
+}
+
 /**
  * @brief QGraphCanvas::showGrid
  * @param shown - indicates whether the graph grid background will be shown
@@ -189,42 +433,420 @@ void QGraphCanvas::showGrid(bool shown)
     Q_D(QGraphCanvas);
 
     d->showGrid( shown );
+    update();
+}
+
+/**
+ * @brief QGraphCanvas::setGridCached
+ * @param cached - whether the grid is drawn from a cached tile pixmap
+ *
+ * Sets whether the grid background is filled with a cached pixmap of a single grid cell used as a tiled brush instead of
+ * drawing the grid lines.  Filling with the tiled pixmap is cheaper on large exposed areas.
+ */
+void QGraphCanvas::setGridCached(bool cached)
+{
+    Q_D(QGraphCanvas);
+
+    d->setGridCached( cached );
+    update();
+}
+
+/**
+ * @brief QGraphCanvas::isGridCached
+ * @return - whether the grid is drawn from a cached tile pixmap
+ */
+bool QGraphCanvas::isGridCached() const
+{
+    Q_D(const QGraphCanvas);
+    return d->isGridCached();
+}
+
+/**
+ * @brief QGraphCanvas::setLevelOfDetailThresholds
+ * @param labelThreshold - the level of detail below which node and edge labels are not drawn
+ * @param shapeThreshold - the level of detail below which nodes are drawn as filled rectangles and edges as straight polylines
+ *
+ * Sets the level of detail thresholds used by the nodes and edges to simplify their rendering when the view is zoomed out.
+ * The level of detail is the scale of the painter transform as returned by QStyleOptionGraphicsItem::levelOfDetailFromTransform().
+ * Passing zero for a threshold always renders the corresponding full detail.
+ */
+void QGraphCanvas::setLevelOfDetailThresholds(qreal labelThreshold, qreal shapeThreshold)
+{
+    Q_D(QGraphCanvas);
+
+    d->setLevelOfDetailThresholds( labelThreshold, shapeThreshold );
+
+    update();
+}
+
+/**
+ * @brief QGraphCanvas::labelLevelOfDetailThreshold
+ * @return - the level of detail below which node and edge labels are not drawn
+ *
+ * Returns the level of detail below which node and edge labels are not drawn.
+ */
+qreal QGraphCanvas::labelLevelOfDetailThreshold() const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->labelLevelOfDetailThreshold();
+}
+
+/**
+ * @brief QGraphCanvas::shapeLevelOfDetailThreshold
+ * @return - the level of detail below which nodes and edges are drawn in simplified form
+ *
+ * Returns the level of detail below which nodes are drawn as filled rectangles and edges as straight polylines.
+ */
+qreal QGraphCanvas::shapeLevelOfDetailThreshold() const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->shapeLevelOfDetailThreshold();
+}
+
+/**
+ * @brief QGraphCanvas::setEdgeHitTestMode
+ * @param mode - the hit test mode of the edges
+ *
+ * Sets how the edges determine whether a point hits them.  QGraphCanvas::EdgeShapeHitTest tests the point against the stroked
+ * outline of the edge returned by QGraphEdge::shape().  QGraphCanvas::EdgePolylineHitTest computes the distance between the
+ * point and the flattened edge path instead, which is cheaper for mouse hover and clicks over dense graphs.  The default
+ * is QGraphCanvas::EdgeShapeHitTest.
+ */
+void QGraphCanvas::setEdgeHitTestMode(EdgeHitTestMode mode)
+{
+    Q_D(QGraphCanvas);
+
+    d->setEdgeHitTestMode( mode );
+}
+
+/**
+ * @brief QGraphCanvas::edgeHitTestMode
+ * @return - the hit test mode of the edges
+ *
+ * Returns how the edges determine whether a point hits them.
+ */
+QGraphCanvas::EdgeHitTestMode QGraphCanvas::edgeHitTestMode() const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->edgeHitTestMode();
+}
+
+/**
+ * @brief QGraphCanvas::setSelectionColor
+ * @param color - the color used to highlight selected nodes and edges
+ *
+ * Sets the color with which the selected nodes and edges are highlighted when painted.  The default is a dark blue.
+ */
+void QGraphCanvas::setSelectionColor(const QColor &color)
+{
+    Q_D(QGraphCanvas);
+
+    d->setSelectionColor( color );
+
+    update();
+}
+
+/**
+ * @brief QGraphCanvas::selectionColor
+ * @return - the color used to highlight selected nodes and edges
+ *
+ * Returns the color with which the selected nodes and edges are highlighted when painted.
+ */
+QColor QGraphCanvas::selectionColor() const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->selectionColor();
+}
+
+/**
+ * @brief QGraphCanvas::setStaticItemIndex
+ * @param enabled - whether the nodes and edges are indexed once after each layout
+ *
+ * Sets whether a packed spatial index of the nodes and edges is built once after each layout and used by graphItems()
+ * and graphItemAt().  As the item geometries do not change between layouts, the index is never updated incrementally.
+ * When enabled, the depth of the scene BSP tree is also chosen from the number of items after each layout.
+ */
+void QGraphCanvas::setStaticItemIndex(bool enabled)
+{
+    Q_D(QGraphCanvas);
+    d->setStaticItemIndex( enabled );
+}
+
+/**
+ * @brief QGraphCanvas::isStaticItemIndex
+ * @return - whether the nodes and edges are indexed once after each layout
+ */
+bool QGraphCanvas::isStaticItemIndex() const
+{
+    Q_D(const QGraphCanvas);
+    return d->isStaticItemIndex();
+}
+
+/**
+ * @brief QGraphCanvas::graphItems
+ * @param rect - the scene rectangle
+ * @return - the nodes and edges whose bounding rectangles intersect the rectangle in ascending stacking order
+ */
+QList<QGraphicsItem*> QGraphCanvas::graphItems(const QRectF &rect) const
+{
+    Q_D(const QGraphCanvas);
+    return d->graphItems( rect );
+}
+
+/**
+ * @brief QGraphCanvas::graphItemAt
+ * @param pos - the scene position
+ * @return - the topmost node or edge whose shape contains the position (NULL if there is none)
+ */
+QGraphicsItem* QGraphCanvas::graphItemAt(const QPointF &pos) const
+{
+    Q_D(const QGraphCanvas);
+    return d->graphItemAt( pos );
+}
+
+/**
+ * @brief QGraphCanvas::collapseNode
+ * @param node - the QGraphNode instance
+ *
+ * Collapses the subtree of the node.  The nodes only reachable from the roots of the graph through the node are hidden
+ * along with their edges; the remaining nodes keep their positions.  Calling updateLayout() or updateLayoutAsync()
+ * afterwards lays out the visible nodes only and thus compacts the graph.
+ */
+void QGraphCanvas::collapseNode(QGraphNode *node)
+{
+    Q_D(QGraphCanvas);
+    d->collapseNode( node );
+}
+
+/**
+ * @brief QGraphCanvas::expandNode
+ * @param node - the QGraphNode instance
+ *
+ * Expands the collapsed subtree of the node.  When an expansion depth is set only that many levels below the node are
+ * revealed and the deepest revealed nodes are collapsed.  The items of nodes never shown before are created now.  If
+ * the graph has been laid out the revealed nodes and edges are placed by updateLayoutIncremental().
+ */
+void QGraphCanvas::expandNode(QGraphNode *node)
+{
+    Q_D(QGraphCanvas);
+    d->expandNode( node );
+}
+
+/**
+ * @brief QGraphCanvas::isCollapsed
+ * @param node - the QGraphNode instance
+ * @return - whether the subtree of the node is collapsed
+ */
+bool QGraphCanvas::isCollapsed(QGraphNode *node) const
+{
+    Q_D(const QGraphCanvas);
+    return d->isCollapsed( node );
+}
+
+/**
+ * @brief QGraphCanvas::collapseCluster
+ * @param name - the name of the cluster subgraph (for instance "cluster_libc")
+ * @return - the summary node replacing the cluster (NULL if there is none)
+ *
+ * Hides the nodes of the cluster and shows a summary node labeled with the label or name of the cluster instead.
+ * The summary node is connected to every node outside the cluster connected to a node of the cluster.  The summary node
+ * and its edges are not added to the graph itself; they are only part of the layouts until the cluster is expanded.
+ * If the graph has been laid out the summary node and its edges are placed by updateLayoutIncremental().
+ */
+QGraphNode* QGraphCanvas::collapseCluster(const QString &name)
+{
+    Q_D(QGraphCanvas);
+    return d->collapseCluster( name );
+}
+
+/**
+ * @brief QGraphCanvas::expandCluster
+ * @param name - the name of the cluster subgraph
+ *
+ * Removes the summary node of the collapsed cluster and reveals the nodes of the cluster.
+ */
+void QGraphCanvas::expandCluster(const QString &name)
+{
+    Q_D(QGraphCanvas);
+    d->expandCluster( name );
+}
+
+/**
+ * @brief QGraphCanvas::isClusterCollapsed
+ * @param name - the name of the cluster subgraph
+ * @return - whether the cluster is collapsed
+ */
+bool QGraphCanvas::isClusterCollapsed(const QString &name) const
+{
+    Q_D(const QGraphCanvas);
+    return d->isClusterCollapsed( name );
+}
+
+/**
+ * @brief QGraphCanvas::setExpansionDepth
+ * @param depth - the number of levels shown of a graph and below an expanded node (0 shows all levels)
+ *
+ * Sets the number of levels of the graph shown initially and revealed by expandNode().  The nodes at the last shown level
+ * with deeper children are collapsed, so the items of the deeper nodes are only created once they are expanded.  The
+ * depth is applied to the current graph, replacing the nodes collapsed so far, and to the graphs read later by
+ * loadGraphAsync(), reload() or loadSnapshot().  By default all levels are shown.
+ */
+void QGraphCanvas::setExpansionDepth(int depth)
+{
+    Q_D(QGraphCanvas);
+    d->setExpansionDepth( depth );
+}
+
+/**
+ * @brief QGraphCanvas::expansionDepth
+ * @return - the number of levels shown below the roots of a graph and below an expanded node (0 if all levels are shown)
+ */
+int QGraphCanvas::expansionDepth() const
+{
+    Q_D(const QGraphCanvas);
+    return d->expansionDepth();
+}
+
+/**
+ * @brief QGraphCanvas::setLayoutCacheDirectory
+ * @param path - the directory where computed layouts are cached (empty disables the layout cache)
+ *
+ * Enables the layout cache.  The layout computed by updateLayout() or updateLayoutAsync() is stored in the directory
+ * under a hash of the graph content and attribute settings.  A later layout of an identical graph - for instance
+ * one constructed again from the same DOT data - restores the cached layout instead of running the layout engine.
+ * A suitable directory is a subdirectory of QStandardPaths::CacheLocation.  The layout cache is disabled by default.
+ */
+void QGraphCanvas::setLayoutCacheDirectory(const QString &path)
+{
+    Q_D(QGraphCanvas);
+    d->setLayoutCacheDirectory( path );
+}
+
+/**
+ * @brief QGraphCanvas::layoutCacheDirectory
+ * @return - the directory where computed layouts are cached
+ *
+ * Returns the directory of the layout cache or an empty string if the layout cache is disabled.
+ */
+QString QGraphCanvas::layoutCacheDirectory() const
+{
+    Q_D(const QGraphCanvas);
+    return d->layoutCacheDirectory();
+}
+
+/**
+ * @brief QGraphCanvas::setNodeAttributes
+ * @param attributeSettings - a list of nodes each with a list of name/value pairs specifying node attribute settings
+ *
+ * Sets the attributes of many nodes in one pass.  Only the styles and colors of the nodes are updated from the new
+ * attributes ("color", "fillcolor" and "style") since these do not affect the layout; other attributes take effect on the
+ * next layout.  The changed nodes are repainted with a single scene update.
+ */
+void QGraphCanvas::setNodeAttributes(const QVector< QPair< QGraphNode*, NameValueList > > &attributeSettings)
+{
+    Q_D(QGraphCanvas);
+    d->setNodeAttributes( attributeSettings );
+}
+
+/**
+ * @brief QGraphCanvas::setNodeColors
+ * @param nodes - the nodes to color
+ * @param values - the value of each node
+ * @param colorMap - the color map as gradient stops in the range [0, 1]
+ * @param minimum - the value mapped to the start of the color map
+ * @param maximum - the value mapped to the end of the color map
+ *
+ * Colors the nodes by value in one pass, e.g. as a heat map of a metric.  Each value is mapped linearly from
+ * [minimum, maximum] onto the color map and the interpolated color is set as the "fillcolor" attribute of the node,
+ * which is filled.  The changed nodes are repainted with a single scene update without a layout.
+ */
+void QGraphCanvas::setNodeColors(const QVector< QGraphNode* > &nodes, const QVector< qreal > &values,
+                                 const QGradientStops &colorMap, qreal minimum, qreal maximum)
+{
+    Q_D(QGraphCanvas);
+    d->setNodeColors( nodes, values, colorMap, minimum, maximum );
 }
 
 /**
  * @brief QGraphCanvas::addGraphNode
  * @param node - the QGraphNode instance to add to the graph canvas
  *
- * Adds a new node instance to the graph.  Connects the QGraphCanvas::layoutUpdated signal
- * to a graph node handler for updating the node state.
+ * Adds a new node instance to the graph.  The node state is updated by the canvas whenever
+ * a new layout is applied.  A node instance for a node which already has one on the canvas is
+ * rejected with a warning and is not added to the scene; it remains owned by the caller.
  */
 void QGraphCanvas::addGraphNode(QGraphNode *node)
 {
-    addItem( node );
+    Q_D(QGraphCanvas);
 
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, node, &QGraphNode::updateState );
-#else
-    connect( this, SIGNAL(layoutUpdated()), node, SLOT(updateState()) );
-#endif
+    if ( d->addGraphNode( node ) )
+        addItem( node );
 }
 
 /**
  * @brief QGraphCanvas::addGraphNode
  * @param edge - the QGraphEdge instance to add to the graph canvas
  *
- * Adds a new edge instance to the graph.  Connects the QGraphCanvas::layoutUpdated signal
- * to a graph edge handler for updating the edge state.
+ * Adds a new edge instance to the graph.  The edge state is updated by the canvas whenever
+ * a new layout is applied.  An edge instance for an edge which already has one on the canvas is
+ * rejected with a warning and is not added to the scene; it remains owned by the caller.
  */
 void QGraphCanvas::addGraphEdge(QGraphEdge *edge)
 {
-    addItem( edge );
+    Q_D(QGraphCanvas);
+
+    if ( d->addGraphEdge( edge ) )
+        addItem( edge );
+}
+
+/**
+ * @brief QGraphCanvas::graphNode
+ * @param name - the name of the node
+ * @return - the QGraphNode instance with the given name (NULL if there is no such node)
+ *
+ * Looks up the node by name in constant time.  The index is maintained by addGraphNode() and the DOT constructor
+ * which keep a single node instance per node name.
+ */
+QGraphNode* QGraphCanvas::graphNode(const QString &name) const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->graphNode( name );
+}
+
+/**
+ * @brief QGraphCanvas::graphEdges
+ * @param tail - the tail node of the edges
+ * @param head - the head node of the edges
+ * @return - the QGraphEdge instances from the tail node to the head node
+ *
+ * Looks up the edges from the tail node to the head node in the index of the edge instances by their
+ * tail and head nodes.  The edges are returned in the order in which they were added to the canvas.
+ */
+QList< QGraphEdge* > QGraphCanvas::graphEdges(QGraphNode *tail, QGraphNode *head) const
+{
+    Q_D(const QGraphCanvas);
+
+    return d->graphEdges( tail, head );
+}
+
+/**
+ * @brief QGraphCanvas::graphEdges
+ * @param tail - the name of the tail node of the edges
+ * @param head - the name of the head node of the edges
+ * @return - the QGraphEdge instances from the tail node to the head node
+ *
+ * Looks up the edges from the tail node to the head node by the node names.
+ */
+QList< QGraphEdge* > QGraphCanvas::graphEdges(const QString &tail, const QString &head) const
+{
+    Q_D(const QGraphCanvas);
 
-#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
-    connect( this, &QGraphCanvas::layoutUpdated, edge, &QGraphEdge::updateState );
-#else
-    connect( this, SIGNAL(layoutUpdated()), edge, SLOT(updateState()) );
-#endif
+    return d->graphEdges( d->graphNode( tail ), d->graphNode( head ) );
 }
 
 /**
@@ -245,7 +867,7 @@ void QGraphCanvas::addItem(QGraphicsItem *item)
  * @param rect - the exposed rectangle within the scene
  *
  * Reimplements the QGraphicsScene::drawBackground method to draw a grid background.
- * All painting is done in scene coordinates.
+ * All painting is done in scene coordinates.  Only the part of the grid within the exposed rectangle is drawn.
  */
 void QGraphCanvas::drawBackground(QPainter *painter, const QRectF &rect)
 {
@@ -254,25 +876,14 @@ void QGraphCanvas::drawBackground(QPainter *painter, const QRectF &rect)
     if ( d->drawGrid() ) {
         painter->save();
 
-        const QPen gridPen(qRgb(240, 240, 240));
-
-        painter->setPen( gridPen );
-
-        const QRectF srect = sceneRect();
-
-        for (qreal x = srect.x(); x <= srect.width(); x+=10.0 ) {
-            painter->drawLine( QLineF( QPointF(x,srect.y()), QPointF(x, srect.height()) ) );
-        }
-
-        for (qreal y = srect.y(); y <= srect.height(); y+=10.0) {
-            painter->drawLine( QLineF( QPointF(srect.x(),y), QPointF(srect.width(),y) ) );
-        }
+        d->paintGrid( painter, rect );
 
         const QPen borderPen( QColor(Qt::gray), 1.5 );
 
         painter->setPen( borderPen );
+        painter->setBrush( Qt::NoBrush );
 
-        painter->drawRect( srect );
+        painter->drawRect( sceneRect() );
 
         painter->restore();
     }
@@ -288,7 +899,12 @@ void QGraphCanvas::drawBackground(QPainter *painter, const QRectF &rect)
  */
 void QGraphCanvas::addGraphNode(void *node)
 {
-    addGraphNode( new QGraphNode( node ) );
+    QGraphNode* graphNode = new QGraphNode( node );
+
+    addGraphNode( graphNode );
+
+    if ( graphNode->scene() != this )
+        delete graphNode;
 }
 
 /**
@@ -299,7 +915,12 @@ void QGraphCanvas::addGraphNode(void *node)
  */
 void QGraphCanvas::addGraphEdge(void *edge)
 {
-    addGraphEdge( new QGraphEdge( edge ) );
+    QGraphEdge* graphEdge = new QGraphEdge( edge );
+
+    addGraphEdge( graphEdge );
+
+    if ( graphEdge->scene() != this )
+        delete graphEdge;
 }
 
 /**
@@ -313,14 +934,59 @@ void QGraphCanvas::handleLayoutUdated()
     setSceneRect( d->boundingBox() );
 }
 
+/**
+ * @brief QGraphCanvas::handleLayoutFinished
+ *
+ * Handler for the completion of an asynchronous layout to apply the new layout to the graph items.
+ */
+void QGraphCanvas::handleLayoutFinished()
+{
+    Q_D(QGraphCanvas);
+    d->handleLayoutFinished();
+}
+
+/**
+ * @brief QGraphCanvas::handleGraphLoaded
+ *
+ * Handler for the completion of the worker thread parsing a graph loaded asynchronously.
+ */
+void QGraphCanvas::handleGraphLoaded()
+{
+    Q_D(QGraphCanvas);
+
+    QFutureWatcher< Agraph_t* >* watcher = static_cast< QFutureWatcher< Agraph_t* >* >( sender() );
+    if ( watcher )
+        d->handleGraphLoaded( watcher );
+}
+
+/**
+ * @brief QGraphCanvas::handleGraphItemCreation
+ *
+ * Handler creating the next time slice of graph items of a graph loaded asynchronously.
+ */
+void QGraphCanvas::handleGraphItemCreation()
+{
+    Q_D(QGraphCanvas);
+    d->createGraphItemsSlice();
+}
+
 /**
  * @brief QGraphCanvas::handleSelectionChanged
  *
  * Handlers for QGraphicsScene::selectionChanged() signal emitted when the
- * selection of graph items in the scene changes.
+ * selection of graph items in the scene changes.  Emits the selectionDelta() signal with the nodes and edges
+ * selected and deselected since the last selection change and, if connected, the graphNodeSelected() and
+ * graphEdgeSelected() signals for every selected item.
  */
 void QGraphCanvas::handleSelectionChanged()
 {
+    Q_D(QGraphCanvas);
+
+    d->emitSelectionDelta();
+
+    if ( receivers( SIGNAL(graphNodeSelected(QGraphNode*)) ) == 0 && receivers( SIGNAL(graphEdgeSelected(QGraphEdge*)) ) == 0 )
+        return;
+
     const QList<QGraphicsItem *> items = selectedItems();
     foreach( QGraphicsItem* item, items ) {
         if ( item->type() == QGraphNode::Type )
@@ -24,14 +24,18 @@
 #ifndef QGRAPHCANVAS_H
 #define QGRAPHCANVAS_H
 
+#include <QBrush>
+#include <QColor>
 #include <QGraphicsScene>
 #include <QList>
 #include <QPair>
+#include <QVector>
 
 #include "argonavis-lib-config.h"
 #include "qtgraphlibrary.h"
 
 class QGraphCanvasPrivate;
+class QIODevice;
 class QGraphNode;
 class QGraphEdge;
 class QGraphicsObject;
@@ -45,12 +49,18 @@ class QTGRAPH_EXPORT QGraphCanvas : public QGraphicsScene
 
     friend class QGraphNode;
     friend class QGraphEdge;
+    friend class QGraphNodePrivate;
+    friend class QGraphEdgePrivate;
 
 public:
 
     typedef QPair< QString, QString > NameValuePair;
     typedef QList< NameValuePair > NameValueList;
 
+    enum LayoutEngine { DotEngine, NeatoEngine, FdpEngine, SfdpEngine, TwopiEngine, CircoEngine };
+
+    enum EdgeHitTestMode { EdgeShapeHitTest, EdgePolylineHitTest };
+
     explicit QGraphCanvas(const QString& name,
                           const NameValueList& graphAttributeSettings = NameValueList(),
                           const NameValueList& nodeAttributeSettings = NameValueList(),
@@ -61,6 +71,11 @@ public:
                           const NameValueList& nodeAttributeSettings = NameValueList(),
                           const NameValueList& edgeAttributeSettings = NameValueList(),
                           QObject *parent = Q_NULLPTR);
+    explicit QGraphCanvas(QIODevice* device,
+                          const NameValueList& graphAttributeSettings = NameValueList(),
+                          const NameValueList& nodeAttributeSettings = NameValueList(),
+                          const NameValueList& edgeAttributeSettings = NameValueList(),
+                          QObject *parent = Q_NULLPTR);
     explicit QGraphCanvas(const QString& name,
                           const QRectF& sceneRect,
                           const NameValueList& graphAttributeSettings = NameValueList(),
@@ -75,20 +90,100 @@ public:
                           QObject *parent = Q_NULLPTR);
     ~QGraphCanvas();
 
+    static QGraphCanvas* fromFile(const QString& fileName,
+                                  const NameValueList& graphAttributeSettings = NameValueList(),
+                                  const NameValueList& nodeAttributeSettings = NameValueList(),
+                                  const NameValueList& edgeAttributeSettings = NameValueList(),
+                                  QObject *parent = Q_NULLPTR);
+
     void addGraphNode(QGraphNode *node);
     void addGraphEdge(QGraphEdge *edge);
 
+    QGraphNode* graphNode(const QString& name) const;
+    QList< QGraphEdge* > graphEdges(QGraphNode* tail, QGraphNode* head) const;
+    QList< QGraphEdge* > graphEdges(const QString& tail, const QString& head) const;
+
+    void loadGraphAsync(const QString& fileName,
+                        const NameValueList& graphAttributeSettings = NameValueList(),
+                        const NameValueList& nodeAttributeSettings = NameValueList(),
+                        const NameValueList& edgeAttributeSettings = NameValueList());
+    void loadGraphAsync(const QByteArray& data,
+                        const NameValueList& graphAttributeSettings = NameValueList(),
+                        const NameValueList& nodeAttributeSettings = NameValueList(),
+                        const NameValueList& edgeAttributeSettings = NameValueList());
+    void cancelLoad();
+    bool isLoading() const;
+
+    void clearGraph();
+    bool reload(QIODevice* device,
+                const NameValueList& graphAttributeSettings = NameValueList(),
+                const NameValueList& nodeAttributeSettings = NameValueList(),
+                const NameValueList& edgeAttributeSettings = NameValueList());
+    bool reload(const QByteArray& data,
+                const NameValueList& graphAttributeSettings = NameValueList(),
+                const NameValueList& nodeAttributeSettings = NameValueList(),
+                const NameValueList& edgeAttributeSettings = NameValueList());
+
+    bool saveSnapshot(const QString& fileName) const;
+    bool loadSnapshot(const QString& fileName);
+
     void updateLayout();
+    void updateLayoutAsync();
+    void updateLayoutIncremental();
+
+    void setLayoutEngine(LayoutEngine engine);
+    LayoutEngine layoutEngine() const;
+
+    void setScalableLayoutEngine(LayoutEngine engine, int nodeThreshold, int edgeThreshold = 0);
 
     void showGrid(bool shown);
+    void setGridCached(bool cached);
+    bool isGridCached() const;
+
+    void setLevelOfDetailThresholds(qreal labelThreshold, qreal shapeThreshold);
+    qreal labelLevelOfDetailThreshold() const;
+    qreal shapeLevelOfDetailThreshold() const;
+
+    void setEdgeHitTestMode(EdgeHitTestMode mode);
+    EdgeHitTestMode edgeHitTestMode() const;
+
+    void setSelectionColor(const QColor& color);
+    QColor selectionColor() const;
+
+    void setStaticItemIndex(bool enabled);
+    bool isStaticItemIndex() const;
+    QList<QGraphicsItem*> graphItems(const QRectF& rect) const;
+    QGraphicsItem* graphItemAt(const QPointF& pos) const;
+
+    void collapseNode(QGraphNode* node);
+    void expandNode(QGraphNode* node);
+    bool isCollapsed(QGraphNode* node) const;
+    QGraphNode* collapseCluster(const QString& name);
+    void expandCluster(const QString& name);
+    bool isClusterCollapsed(const QString& name) const;
+    void setExpansionDepth(int depth);
+    int expansionDepth() const;
+
+    void setLayoutCacheDirectory(const QString& path);
+    QString layoutCacheDirectory() const;
+
+    void setNodeAttributes(const QVector< QPair< QGraphNode*, NameValueList > >& attributeSettings);
+    void setNodeColors(const QVector< QGraphNode* >& nodes, const QVector< qreal >& values,
+                       const QGradientStops& colorMap, qreal minimum = 0.0, qreal maximum = 1.0);
 
 signals:
 
     void layoutUpdated();
 
+    void loadProgress(int value, int maximum);
+    void loadFinished(bool success);
+
     void graphNodeSelected(QGraphNode* node);
     void graphEdgeSelected(QGraphEdge* edge);
 
+    void selectionDelta(const QList< QGraphNode* >& addedNodes, const QList< QGraphNode* >& removedNodes,
+                        const QList< QGraphEdge* >& addedEdges, const QList< QGraphEdge* >& removedEdges);
+
 protected:
 
     void addItem(QGraphicsItem *item);
@@ -100,7 +195,10 @@ protected:
 private slots:
 
     void handleLayoutUdated();
+    void handleLayoutFinished();
     void handleSelectionChanged();
+    void handleGraphLoaded();
+    void handleGraphItemCreation();
 
 protected:
 
@@ -23,12 +23,14 @@
 
 #include "QGraphEdge.h"
 #include "QGraphEdgePrivate.h"
+#include "QGraphCanvasPrivate.h"
+#include "QGraphViewPrivate.h"
 
 #include "QGraphCanvas.h"
 #include "QGraphNode.h"
 
 #include <QPainter>
-#include <QGraphicsColorizeEffect>
+#include <QStyleOptionGraphicsItem>
 
 
 /**
@@ -74,9 +76,43 @@ QGraphEdge::QGraphEdge(void *edge, QGraphicsItem *parent)
 QGraphEdge::~QGraphEdge()
 {
     Q_D(QGraphEdge);
+
+    // pending selection changes must not refer to the destroyed edge
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+    if ( canvas )
+        canvas->d_func()->itemDestroyed( this );
+
     delete d;
 }
 
+/**
+ * @brief QGraphEdge::itemChange
+ * @param change - the parameter of the item that is changing
+ * @param value - the new value of the parameter
+ * @return - the final value of the parameter
+ *
+ * Reimplementation of the QGraphicsObject::itemChange virtual function used to notify instance
+ * that some part of the item's state changed.  In particular, when the selection state of the item changes,
+ * this function records the change for the next QGraphCanvas::selectionDelta() signal.  Changes of the scene or the
+ * visibility of the item invalidate the static item index of the canvas.
+ */
+QVariant QGraphEdge::itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value)
+{
+    if ( change == ItemSelectedHasChanged ) {
+        QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+        if ( canvas )
+            canvas->d_func()->itemSelectionChanged( this, value.toBool() );
+    }
+    else if ( change == ItemSceneChange || change == ItemSceneHasChanged || change == ItemVisibleHasChanged ) {
+        // the static item index of the canvas the edge leaves or joins no longer matches its items
+        QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+        if ( canvas )
+            canvas->d_func()->invalidateItemIndex();
+    }
+
+    return QGraphicsObject::itemChange( change, value );
+}
+
 /**
  * @brief QGraphEdge::updateState
  *
@@ -87,6 +123,10 @@ void QGraphEdge::updateState()
     Q_D(QGraphEdge);
     prepareGeometryChange();
     d->updateState();
+
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+    if ( canvas )
+        canvas->d_func()->invalidateItemIndex();
 }
 
 /**
@@ -103,47 +143,39 @@ QRectF QGraphEdge::boundingRect() const
 }
 
 /**
- * @brief QGraphEdge::itemChange
- * @param change - the parameter of the item that is changing
- * @param value - the new value of the parameter
- * @return - the final value of the parameter
+ * @brief QGraphEdge::shape
+ * @return - the painter path representing the outline of the edge
  *
- * Reimplementation of the QGraphicsObject::itemChange virtual function used to notify instance
- * that some part of the item's state changed.  In particular, when the item is selected, this function
- * sets the graphics effect on the instance and when it is no longer selected removes the graphics effect.
+ * Reimplementation of the QGraphicsObject::shape virtual function used to generate a QPainterPath
+ * representation of the outline of the edge instance.
  */
-QVariant QGraphEdge::itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value)
+QPainterPath QGraphEdge::shape() const
 {
-    if ( change == ItemSelectedHasChanged ) {
-        bool selected = value.toBool();
-        if ( selected )
-            setGraphicsEffect( new QGraphicsColorizeEffect );  // ownership is passed to base class implementation
-        else
-            setGraphicsEffect( 0 );  // remove graphics effects
-    }
+    Q_D(const QGraphEdge);
 
-    return QGraphicsObject::itemChange( change, value );
+    // the outline of the combined painter path is cached until the state of the edge changes
+    return d->selectionShape();
 }
 
 /**
- * @brief QGraphEdge::shape
- * @return - the painter path representing the outline of the edge
+ * @brief QGraphEdge::contains
+ * @param point - the point in local graphics item coordinates
+ * @return - whether the point is contained by the edge
  *
- * Reimplementation of the QGraphicsObject::shape virtual function used to generate a QPainterPath
- * representation of the outline of the edge instance.
+ * Reimplementation of the QGraphicsObject::contains virtual function used to hit test the edge.  When the canvas
+ * uses the QGraphCanvas::EdgePolylineHitTest mode the distance between the point and the flattened edge path is
+ * tested instead of the outline returned by shape().
  */
-QPainterPath QGraphEdge::shape() const
+bool QGraphEdge::contains(const QPointF &point) const
 {
     Q_D(const QGraphEdge);
-    // initialize a painter path stroker to generate an outline of the edge and edge label painter paths
-    // this will make a slight larger area to make it easier for the user to select edges
-    QPainterPathStroker stroker;
-    stroker.setWidth( 20 );
-    // create a path containing both edge path, edge arrow path and edge label bounding box
-    QPainterPath jointPath( d->m_path );
-    jointPath.addRect( d->m_labelPath.boundingRect() );
-    // return the outline of the combined painter path
-    return stroker.createStroke( jointPath );
+
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+
+    if ( canvas && QGraphCanvas::EdgePolylineHitTest == canvas->edgeHitTestMode() )
+        return d->polylineContains( point );
+
+    return QGraphicsObject::contains( point );
 }
 
 /**
@@ -153,35 +185,20 @@ QPainterPath QGraphEdge::shape() const
  * @param widget - it points to the widget that is being painted on (for cached painting this is NULL)
  *
  * Reimplementation of the QGraphicsObject::paint virtual function used to draw the edge on the graph canvas.
+ * Below the level of detail thresholds of the canvas the label is skipped and the edge is drawn as straight polylines.
+ * Selected edges are drawn with a wider pen of the selection color of the canvas.  Edges which are not selected are
+ * skipped when they are drawn from the tiles of a QGraphView with tiled rendering enabled.
  */
 void QGraphEdge::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
     Q_UNUSED(option);
-    Q_UNUSED(widget);
     Q_D(QGraphEdge);
 
-    painter->save();
-
-    QPen pPen( painter->pen() );
+    const bool selected = isSelected();
 
-    if ( isSelected() ) {
-        QPen pen( pPen );
-        pen.setWidthF( pPen.widthF() * 2.0 );
-        painter->setPen( pen );
-    }
-
-    painter->drawPath( d->m_path );
-
-    painter->setBrush( painter->pen().color() );
-
-    painter->drawPath( d->m_arrowPath );
-
-    if ( ! d->m_labelPath.isEmpty() ) {
-        QPen pen( d->m_fontColor, pPen.widthF() / 4.0 );
-        painter->setPen( pen );
-        painter->setBrush( QBrush( d->m_fontColor, Qt::SolidPattern ) );
-        painter->drawPath( d->m_labelPath );
-    }
+    // static edges are drawn from the rasterized tiles of a QGraphView with tiled rendering enabled
+    if ( ! selected && QGraphViewPrivate::isTiledViewport( widget ) )
+        return;
 
-    painter->restore();
+    QGraphEdgePrivate::paint( painter, d->state(), QGraphNodePrivate::paintOptions( scene() ), selected );
 }
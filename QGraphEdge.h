@@ -41,6 +41,8 @@ class QTGRAPH_EXPORT QGraphEdge : public QGraphicsObject
     Q_DECLARE_PRIVATE(QGraphEdge)
 
     friend class QGraphCanvas;
+    friend class QGraphCanvasPrivate;
+    friend class QGraphViewPrivate;
 
 public:
 
@@ -60,8 +62,9 @@ protected:
 
     explicit QGraphEdge(void* edge, QGraphicsItem *parent = Q_NULLPTR);
 
-    virtual QVariant itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value) Q_DECL_OVERRIDE;
+    virtual QVariant itemChange(GraphicsItemChange change, const QVariant &value) Q_DECL_OVERRIDE;
     virtual QPainterPath shape() const Q_DECL_OVERRIDE;
+    virtual bool contains(const QPointF &point) const Q_DECL_OVERRIDE;
     virtual QRectF boundingRect() const Q_DECL_OVERRIDE;
     virtual void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget = Q_NULLPTR) Q_DECL_OVERRIDE;
 
@@ -23,11 +23,13 @@
 
 #include "QGraphNode.h"
 #include "QGraphNodePrivate.h"
+#include "QGraphCanvasPrivate.h"
+#include "QGraphViewPrivate.h"
 
 #include "QGraphCanvas.h"
 
 #include <QPainter>
-#include <QGraphicsColorizeEffect>
+#include <QStyleOptionGraphicsItem>
 #include <QDebug>
 
 
@@ -70,6 +72,12 @@ QGraphNode::QGraphNode(void *node, QGraphicsItem *parent)
 QGraphNode::~QGraphNode()
 {
     Q_D(QGraphNode);
+
+    // pending selection changes must not refer to the destroyed node
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+    if ( canvas )
+        canvas->d_func()->itemDestroyed( this );
+
     delete d;
 }
 
@@ -80,17 +88,22 @@ QGraphNode::~QGraphNode()
  * @return - the final value of the parameter
  *
  * Reimplementation of the QGraphicsObject::itemChange virtual function used to notify instance
- * that some part of the item's state changed.  In particular, when the item is selected, this function
- * sets the graphics effect on the instance and when it is no longer selected removes the graphics effect.
+ * that some part of the item's state changed.  In particular, when the selection state of the item changes,
+ * this function records the change for the next QGraphCanvas::selectionDelta() signal.  Changes of the scene or the
+ * visibility of the item invalidate the static item index of the canvas.
  */
 QVariant QGraphNode::itemChange(QGraphicsItem::GraphicsItemChange change, const QVariant &value)
 {
     if ( change == ItemSelectedHasChanged ) {
-        bool selected = value.toBool();
-        if ( selected )
-            setGraphicsEffect( new QGraphicsColorizeEffect );  // ownership is passed to base class implementation
-        else
-            setGraphicsEffect( 0 );  // remove graphics effects
+        QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+        if ( canvas )
+            canvas->d_func()->itemSelectionChanged( this, value.toBool() );
+    }
+    else if ( change == ItemSceneChange || change == ItemSceneHasChanged || change == ItemVisibleHasChanged ) {
+        // the static item index of the canvas the node leaves or joins no longer matches its items
+        QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+        if ( canvas )
+            canvas->d_func()->invalidateItemIndex();
     }
 
     return QGraphicsObject::itemChange( change, value );
@@ -132,6 +145,10 @@ void QGraphNode::updateState()
     Q_D(QGraphNode);
     prepareGeometryChange();
     d->updateState();
+
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene() );
+    if ( canvas )
+        canvas->d_func()->invalidateItemIndex();
 }
 
 /**
@@ -154,26 +171,20 @@ QRectF QGraphNode::boundingRect() const
  * @param widget -it points to the widget that is being painted on (for cached painting this is NULL)
  *
  * Reimplementation of the QGraphicsObject::paint virtual function used to draw the node on the graph canvas.
+ * Below the level of detail thresholds of the canvas the label is skipped and the node is drawn as a filled rectangle.
+ * Selected nodes are outlined with the selection color of the canvas.  Nodes which are not selected are skipped when
+ * they are drawn from the tiles of a QGraphView with tiled rendering enabled.
  */
 void QGraphNode::paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *widget)
 {
     Q_UNUSED(option);
-    Q_UNUSED(widget);
     Q_D(QGraphNode);
 
-    if ( d->m_styles.contains( QGraphNodePrivate::Invisible ) )
-         return;
-
-    painter->save();
-
-    painter->setBrush( d->m_fillColor );
-    painter->setPen ( d->m_penColor );
-
-    painter->drawPath( d->m_path );
+    const bool selected = isSelected();
 
-    // for now not rendered as painter path generated in updateState() but may have to change if
-    // node labels can extend outside the node bounding rectangle
-    d->drawLabel( painter );
+    // static nodes are drawn from the rasterized tiles of a QGraphView with tiled rendering enabled
+    if ( ! selected && QGraphViewPrivate::isTiledViewport( widget ) )
+        return;
 
-    painter->restore();
+    QGraphNodePrivate::paint( painter, d->state(), QGraphNodePrivate::paintOptions( scene() ), selected );
 }
@@ -40,6 +40,8 @@ class QTGRAPH_EXPORT QGraphNode : public QGraphicsObject
     Q_DECLARE_PRIVATE(QGraphNode)
 
     friend class QGraphCanvas;
+    friend class QGraphCanvasPrivate;
+    friend class QGraphViewPrivate;
     friend class QGraphEdge;
 
 public:
@@ -0,0 +1,308 @@
+/*!
+   \file QGraphView.cpp
+   \author Gregory Schultz <gregory.schultz@embarqmail.com>
+
+   \section LICENSE
+   This file is part of the Open|SpeedShop Graphical User Interface
+   Copyright (C) 2010-2017 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "QGraphView.h"
+#include "QGraphViewPrivate.h"
+
+#include <QElapsedTimer>
+#include <QPainter>
+#include <QWheelEvent>
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
+#include <QtMath>
+#else
+#include "qmath.h"
+#endif
+
+
+/**
+ * @brief QGraphView::QGraphView
+ * @param parent - the parent widget
+ *
+ * Constructs a QGraphView instance without a scene.  The view is tuned for large graphs: the bounding rectangle of
+ * the changed items is repainted, painter state is neither saved nor adjusted for antialiasing around each item, the
+ * background is cached, zooming is anchored under the mouse and antialiasing is disabled while scrolling.
+ */
+QGraphView::QGraphView(QWidget *parent)
+    : QGraphicsView( parent )
+    , d_ptr( new QGraphViewPrivate( this ) )
+{
+
+}
+
+/**
+ * @brief QGraphView::QGraphView
+ * @param scene - the scene to visualize
+ * @param parent - the parent widget
+ *
+ * Constructs a QGraphView instance visualizing the specified scene with the same defaults as above.
+ */
+QGraphView::QGraphView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView( scene, parent )
+    , d_ptr( new QGraphViewPrivate( this ) )
+{
+
+}
+
+/**
+ * @brief QGraphView::~QGraphView
+ *
+ * Destroys the QGraphView instance.
+ */
+QGraphView::~QGraphView()
+{
+    Q_D(QGraphView);
+    delete d;
+}
+
+/**
+ * @brief QGraphView::setTiledRendering
+ * @param enabled - whether static nodes and edges are drawn from rasterized tiles
+ *
+ * Sets whether the nodes and edges which are not selected are rasterized into tiles keyed by zoom level and drawn
+ * from the tiles while panning instead of being painted individually.  Tiles are rendered on worker threads and only
+ * the tiles covering changed items are rendered again.  Tiles are only used while the view transform is a uniform
+ * scale; rotated or sheared views paint the items directly.
+ */
+void QGraphView::setTiledRendering(bool enabled)
+{
+    Q_D(QGraphView);
+
+    d->setTiledRendering( enabled );
+    resetCachedContent();
+    viewport()->update();
+}
+
+/**
+ * @brief QGraphView::isTiledRendering
+ * @return - whether static nodes and edges are drawn from rasterized tiles
+ */
+bool QGraphView::isTiledRendering() const
+{
+    Q_D(const QGraphView);
+    return d->isTiledRendering();
+}
+
+/**
+ * @brief QGraphView::setTileCacheLimit
+ * @param kilobytes - the maximum size of the cached tile images in kilobytes
+ *
+ * Sets the maximum size of the rasterized tiles kept in the tile cache.  The least recently drawn tiles are
+ * discarded first.
+ */
+void QGraphView::setTileCacheLimit(int kilobytes)
+{
+    Q_D(QGraphView);
+    d->setTileCacheLimit( kilobytes );
+}
+
+/**
+ * @brief QGraphView::tileCacheLimit
+ * @return - the maximum size of the cached tile images in kilobytes
+ */
+int QGraphView::tileCacheLimit() const
+{
+    Q_D(const QGraphView);
+    return d->tileCacheLimit();
+}
+
+/**
+ * @brief QGraphView::setZoomRange
+ * @param minimum - the minimum scale of the view
+ * @param maximum - the maximum scale of the view
+ *
+ * Sets the range to which zooming with the mouse wheel or zoomBy() is limited.
+ */
+void QGraphView::setZoomRange(qreal minimum, qreal maximum)
+{
+    Q_D(QGraphView);
+    d->setZoomRange( minimum, maximum );
+}
+
+/**
+ * @brief QGraphView::minimumZoom
+ * @return - the minimum scale of the view
+ */
+qreal QGraphView::minimumZoom() const
+{
+    Q_D(const QGraphView);
+    return d->minimumZoom();
+}
+
+/**
+ * @brief QGraphView::maximumZoom
+ * @return - the maximum scale of the view
+ */
+qreal QGraphView::maximumZoom() const
+{
+    Q_D(const QGraphView);
+    return d->maximumZoom();
+}
+
+/**
+ * @brief QGraphView::zoom
+ * @return - the current scale of the view
+ */
+qreal QGraphView::zoom() const
+{
+    return transform().mapRect( QRectF( 0, 0, 1, 1 ) ).width();
+}
+
+/**
+ * @brief QGraphView::zoomBy
+ * @param factor - the factor by which the view is scaled
+ *
+ * Scales the view by the specified factor around the transformation anchor unless the resulting scale is outside
+ * the zoom range.
+ */
+void QGraphView::zoomBy(qreal factor)
+{
+    Q_D(QGraphView);
+    d->zoomBy( factor );
+}
+
+/**
+ * @brief QGraphView::setFastScrolling
+ * @param enabled - whether antialiasing is disabled while scrolling
+ *
+ * Sets whether antialiasing and smooth pixmap transformation are disabled while the view is scrolled or zoomed and
+ * re-enabled once the view has been idle for a short while.
+ */
+void QGraphView::setFastScrolling(bool enabled)
+{
+    Q_D(QGraphView);
+    d->setFastScrolling( enabled );
+}
+
+/**
+ * @brief QGraphView::isFastScrolling
+ * @return - whether antialiasing is disabled while scrolling
+ */
+bool QGraphView::isFastScrolling() const
+{
+    Q_D(const QGraphView);
+    return d->isFastScrolling();
+}
+
+/**
+ * @brief QGraphView::paintEvent
+ * @param event - the paint event
+ *
+ * Reimplementation of the QGraphicsView::paintEvent virtual function emitting the framePainted() signal with the time
+ * spent painting the viewport.
+ */
+void QGraphView::paintEvent(QPaintEvent *event)
+{
+    QElapsedTimer timer;
+    timer.start();
+
+    QGraphicsView::paintEvent( event );
+
+    emit framePainted( timer.nsecsElapsed() );
+}
+
+/**
+ * @brief QGraphView::wheelEvent
+ * @param event - the wheel event
+ *
+ * Reimplementation of the QGraphicsView::wheelEvent virtual function zooming the view under the mouse.
+ */
+void QGraphView::wheelEvent(QWheelEvent *event)
+{
+    zoomBy( qPow( 2.0, event->delta() / 240.0 ) ); // how fast zooming occurs
+    event->accept();
+}
+
+/**
+ * @brief QGraphView::scrollContentsBy
+ * @param dx - the horizontal scroll distance in pixels
+ * @param dy - the vertical scroll distance in pixels
+ *
+ * Reimplementation of the QAbstractScrollArea::scrollContentsBy virtual function disabling antialiasing while scrolling.
+ */
+void QGraphView::scrollContentsBy(int dx, int dy)
+{
+    Q_D(QGraphView);
+
+    d->beginScrolling();
+
+    QGraphicsView::scrollContentsBy( dx, dy );
+}
+
+/**
+ * @brief QGraphView::drawBackground
+ * @param painter - the view painter instance in scene coordinates
+ * @param rect - the exposed rectangle in scene coordinates
+ *
+ * Reimplementation of the QGraphicsView::drawBackground virtual function drawing the scene background followed by
+ * the rasterized tiles of the static nodes and edges when tiled rendering is enabled.
+ */
+void QGraphView::drawBackground(QPainter *painter, const QRectF &rect)
+{
+    Q_D(QGraphView);
+
+    QGraphicsView::drawBackground( painter, rect );
+
+    if ( scene() != d->m_tileScene )
+        d->attachScene();
+
+    if ( d->isTilingActive() )
+        d->drawTiles( painter, rect );
+}
+
+/**
+ * @brief QGraphView::handleSceneChanged
+ * @param region - the changed scene rectangles
+ *
+ * Handler for the changes of the scene invalidating the tiles covering the changed scene rectangles.
+ */
+void QGraphView::handleSceneChanged(const QList<QRectF> &region)
+{
+    Q_D(QGraphView);
+    d->invalidateTiles( region );
+}
+
+/**
+ * @brief QGraphView::handleTileRendered
+ *
+ * Handler for the completion of the worker thread rendering a tile.
+ */
+void QGraphView::handleTileRendered()
+{
+    Q_D(QGraphView);
+
+    QFutureWatcher< QGraphViewPrivate::TileResult >* watcher = static_cast< QFutureWatcher< QGraphViewPrivate::TileResult >* >( sender() );
+    if ( watcher )
+        d->handleTileRendered( watcher );
+}
+
+/**
+ * @brief QGraphView::handleScrollingFinished
+ *
+ * Handler for the view being idle after scrolling or zooming re-enabling antialiasing.
+ */
+void QGraphView::handleScrollingFinished()
+{
+    Q_D(QGraphView);
+    d->endScrolling();
+}
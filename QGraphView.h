@@ -0,0 +1,90 @@
+/*!
+   \file QGraphView.h
+   \author Gregory Schultz <gregory.schultz@embarqmail.com>
+
+   \section LICENSE
+   This file is part of the Open|SpeedShop Graphical User Interface
+   Copyright (C) 2010-2017 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef QGRAPHVIEW_H
+#define QGRAPHVIEW_H
+
+#include <QGraphicsView>
+#include <QList>
+#include <QRectF>
+
+#include "argonavis-lib-config.h"
+#include "qtgraphlibrary.h"
+
+class QGraphViewPrivate;
+
+
+class QTGRAPH_EXPORT QGraphView : public QGraphicsView
+{
+    Q_OBJECT
+    Q_DISABLE_COPY(QGraphView)
+    Q_DECLARE_PRIVATE(QGraphView)
+
+public:
+
+    explicit QGraphView(QWidget *parent = Q_NULLPTR);
+    explicit QGraphView(QGraphicsScene *scene, QWidget *parent = Q_NULLPTR);
+    ~QGraphView();
+
+    void setTiledRendering(bool enabled);
+    bool isTiledRendering() const;
+
+    void setTileCacheLimit(int kilobytes);
+    int tileCacheLimit() const;
+
+    void setZoomRange(qreal minimum, qreal maximum);
+    qreal minimumZoom() const;
+    qreal maximumZoom() const;
+    qreal zoom() const;
+
+    void setFastScrolling(bool enabled);
+    bool isFastScrolling() const;
+
+public slots:
+
+    void zoomBy(qreal factor);
+
+signals:
+
+    void framePainted(qint64 nanoseconds);
+
+protected:
+
+    virtual void paintEvent(QPaintEvent *event) Q_DECL_OVERRIDE;
+    virtual void wheelEvent(QWheelEvent *event) Q_DECL_OVERRIDE;
+    virtual void scrollContentsBy(int dx, int dy) Q_DECL_OVERRIDE;
+    virtual void drawBackground(QPainter *painter, const QRectF &rect) Q_DECL_OVERRIDE;
+
+private slots:
+
+    void handleSceneChanged(const QList<QRectF>& region);
+    void handleTileRendered();
+    void handleScrollingFinished();
+
+protected:
+
+    QGraphViewPrivate* const d_ptr;
+
+};
+
+#endif // QGRAPHVIEW_H
@@ -4,7 +4,7 @@
 
 QT       += core gui
 
-greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): CONFIG += c++11
 else: QMAKE_CXXFLAGS += -std=c++11
@@ -38,21 +38,25 @@ PUBLIC_HEADERS += \
            common/qtgraphlibrary.h \
            QGraphCanvas.h \
            QGraphEdge.h \
-           QGraphNode.h
+           QGraphNode.h \
+           QGraphView.h
 
 PRIVATE_HEADERS += \
            private/QGraphCanvasPrivate.h \
            private/QGraphEdgePrivate.h \
-           private/QGraphNodePrivate.h
+           private/QGraphNodePrivate.h \
+           private/QGraphViewPrivate.h
 
 HEADERS += $$PUBLIC_HEADERS $$PRIVATE_HEADERS
 
 SOURCES += QGraphCanvas.cpp \
            QGraphEdge.cpp \
            QGraphNode.cpp \
+           QGraphView.cpp \
            private/QGraphCanvasPrivate.cpp \
            private/QGraphEdgePrivate.cpp \
-           private/QGraphNodePrivate.cpp
+           private/QGraphNodePrivate.cpp \
+           private/QGraphViewPrivate.cpp
 
 contains(BUILD, x86_64) {
     target.path = $$INSTALL_PATH/lib64/$$QT_VERSION
@@ -23,33 +23,16 @@
 
 #include "GraphView.h"
 
-#include <QWheelEvent>
-
-#if (QT_VERSION >= QT_VERSION_CHECK(5, 0, 0))
-#include <QtMath>
-#else
-#include "qmath.h"
-#endif
-
 
 GraphView::GraphView(QWidget *parent)
-    : QGraphicsView( parent )
+    : QGraphView( parent )
 {
-
+    // draw the static nodes and edges from tiles rasterized on worker threads
+    setTiledRendering( true );
 }
 
 GraphView::GraphView(QGraphicsScene *scene, QWidget *parent)
-    : QGraphicsView( scene, parent )
-{
-
-}
-
-void GraphView::wheelEvent(QWheelEvent* event)
+    : QGraphView( scene, parent )
 {
-    qreal scaleFactor = qPow( 2.0, event->delta() / 240.0 ); // how fast zooming occurs
-    qreal factor = transform().scale( scaleFactor, scaleFactor ).mapRect( QRectF(0, 0, 1, 1) ).width();
-    if ( 0.05 < factor && factor < 10.0 ) {
-        // limit zoom extents
-        scale( scaleFactor, scaleFactor );
-    }
+    setTiledRendering( true );
 }
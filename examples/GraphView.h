@@ -24,19 +24,15 @@
 #ifndef GRAPHVIEW_H
 #define GRAPHVIEW_H
 
-#include <QGraphicsView>
+#include "QtGraph/QGraphView.h"
 
 
-class GraphView : public QGraphicsView
+class GraphView : public QGraphView
 {
 public:
 
     explicit GraphView(QWidget *parent = 0);
 
-protected:
-
-    void wheelEvent(QWheelEvent *event);
-
 private:
 
     explicit GraphView(QGraphicsScene *scene, QWidget *parent = 0);
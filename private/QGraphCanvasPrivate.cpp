@@ -32,8 +32,91 @@
 #include "graphviz/cgraph.h"
 #include "graphviz/gvc.h"
 
+#include <QApplication>
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDesktopWidget>
+#include <QDataStream>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#if (QT_VERSION >= QT_VERSION_CHECK(5,1,0))
+#include <QSaveFile>
+#endif
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QStyleOptionGraphicsItem>
+#include <QtConcurrentMap>
+#include <QtConcurrentRun>
+#include <QTimer>
 #include <QDebug>
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+
+Q_GLOBAL_STATIC(QMutex, s_graphvizMutex)
+
+// Graphviz context shared by all canvases and the number of canvases using it (guarded by the Graphviz library mutex)
+static GVC_t* s_sharedContext = NULL;
+static int s_sharedContextRefCount = 0;
+
+// grid spacing in scene units at 100% zoom and the minimum grid spacing in device pixels
+static const qreal GRID_SPACING = 10.0;
+static const qreal MIN_GRID_PIXEL_SPACING = 8.0;
+
+// time in milliseconds spent creating graph items per event loop iteration during an asynchronous load
+static const int LOAD_TIME_SLICE = 20;
+
+// record bound to the libcgraph nodes and edges referring to their graphics items
+static const char* ITEM_RECORD_NAME = "QGraphItem";
+
+struct ItemRecord {
+    Agrec_t header;
+    QGraphicsObject* item;
+};
+
+// record bound to the root libcgraph graphs caching the well-known attribute symbols
+static const char* SYMBOL_RECORD_NAME = "QGraphSymbols";
+
+struct SymbolRecord {
+    Agrec_t header;
+    Agsym_t* symbols[ QGraphCanvasPrivate::AttributeSymbolCount ];
+};
+
+// kinds and names of the well-known attribute symbols
+static const int SYMBOL_KINDS[ QGraphCanvasPrivate::AttributeSymbolCount ] = { AGNODE, AGNODE, AGNODE };
+static const char* SYMBOL_NAMES[ QGraphCanvasPrivate::AttributeSymbolCount ] = { "color", "fillcolor", "style" };
+
+// label fonts keyed by font name and pixel size
+typedef QHash< QPair< QString, int >, QFont > LabelFontCache;
+Q_GLOBAL_STATIC(LabelFontCache, s_labelFontCache)
+Q_GLOBAL_STATIC(QMutex, s_labelFontCacheMutex)
+
+// layout cache file identification and format version
+static const quint32 LAYOUT_CACHE_MAGIC = 0x51474c43;  // "QGLC"
+static const quint32 LAYOUT_CACHE_VERSION = 1;
+
+// the bounding box written back onto the graph by gvLayout() is an output of the layout and not part of the cache key
+static const char* LAYOUT_OUTPUT_ATTRIBUTE = "bb";
+
+// graph snapshot file identification and format version
+static const quint32 SNAPSHOT_MAGIC = 0x51475353;  // "QGSS"
+static const quint32 SNAPSHOT_VERSION = 1;
+
+// average number of items per cell of the static item index and the maximum number of cells
+static const int ITEMS_PER_INDEX_CELL = 4;
+static const int MAX_INDEX_CELLS = 1 << 20;
+
+// average number of items per leaf of the scene BSP tree and the limits of the BSP tree depth chosen from the item count
+static const int ITEMS_PER_BSP_LEAF = 8;
+static const int MIN_BSP_TREE_DEPTH = 5;
+static const int MAX_BSP_TREE_DEPTH = 18;
+
 
 /**
  * @brief QGraphCanvasPrivate::QGraphCanvasPrivate
@@ -51,10 +134,8 @@ QGraphCanvasPrivate::QGraphCanvasPrivate(const QString &name,
                                          const QGraphCanvas::NameValueList& edgeAttributeSettings,
                                          QGraphCanvas *parent)
     : q_ptr( parent )
-    , m_drawGrid( false )
 {
-    //  set up a graphviz context - and init graph - retaining old API
-    m_gvc = gvContext();
+    init();
 
     // open graph
     m_graph = agopen( name.toLocal8Bit().data(), Agdirected, NULL );
@@ -72,7 +153,7 @@ QGraphCanvasPrivate::QGraphCanvasPrivate(const QString &name,
  * @param parent - the QGraphCanvas parent
  *
  * Constructs an QGraphCanvasPrivate instance of the given QGraphCanvas parent from a pointer to a DOT formatted
- * character array in memory.  The graph nodes and edges will be created automatically.
+ * character array in memory.  The graph items are created by the QGraphCanvas constructor once its d_ptr is set.
  */
 QGraphCanvasPrivate::QGraphCanvasPrivate(const char *data,
                                          const QGraphCanvas::NameValueList& graphAttributeSettings,
@@ -80,26 +161,327 @@ QGraphCanvasPrivate::QGraphCanvasPrivate(const char *data,
                                          const QGraphCanvas::NameValueList& edgeAttributeSettings,
                                          QGraphCanvas *parent)
     : q_ptr( parent )
-    , m_drawGrid( false )
 {
-    //  set up a graphviz context - and init graph - retaining old API
-    m_gvc = gvContext();
-
-    m_graph = agmemread( data );
+    init();
 
-    if ( m_graph ) {
-        for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
-            q_ptr->addGraphNode( node );
-            for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
-                q_ptr->addGraphEdge( edge  );
-            }
-        }
+    {
+        // the libcgraph parser is not reentrant
+        QMutexLocker locker( graphvizMutex() );
+        m_graph = agmemread( data );
     }
 
     // set default attributes
     setAttributes( graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
 }
 
+/**
+ * @brief QGraphCanvasPrivate::QGraphCanvasPrivate
+ * @param device - the device from which the DOT formatted graph is read
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @param parent - the QGraphCanvas parent
+ *
+ * Constructs an QGraphCanvasPrivate instance of the given QGraphCanvas parent from a DOT formatted graph
+ * streamed from the device.  The graph items are created by the QGraphCanvas constructor once its d_ptr is set.
+ */
+QGraphCanvasPrivate::QGraphCanvasPrivate(QIODevice *device,
+                                         const QGraphCanvas::NameValueList& graphAttributeSettings,
+                                         const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                                         const QGraphCanvas::NameValueList& edgeAttributeSettings,
+                                         QGraphCanvas *parent)
+    : q_ptr( parent )
+{
+    init();
+
+    m_graph = readGraph( device );
+
+    // set default attributes
+    setAttributes( graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::init
+ *
+ * Initializes the state shared by all constructors, gets the shared Graphviz context and connects the canvas to its
+ * own signals and to the layout watcher.  The constructors create or read the graph afterwards.
+ */
+void QGraphCanvasPrivate::init()
+{
+    Q_Q(QGraphCanvas);
+
+    //  get the shared graphviz context - and init graph - retaining old API
+    m_gvc = acquireContext();
+    m_graph = Q_NULLPTR;
+    m_graphLaidOut = false;
+    m_drawGrid = false;
+    m_gridCached = false;
+    m_labelLevelOfDetailThreshold = 0.4;
+    m_shapeLevelOfDetailThreshold = 0.15;
+    m_edgeHitTestMode = QGraphCanvas::EdgeShapeHitTest;
+    m_selectionColor = QColor( 0, 0, 192 );
+    m_staticItemIndex = false;
+    m_expansionDepth = 0;
+    m_summaryGraph = Q_NULLPTR;
+    m_layoutMirrorY = 0.0;
+    m_generation = 0;
+    m_latestGeneration = QSharedPointer< QAtomicInt >( new QAtomicInt( 0 ) );
+    m_layoutWatcher = new QFutureWatcher< LayoutResult >( q );
+    m_layoutEngine = QGraphCanvas::DotEngine;
+    m_scalableLayoutEngine = QGraphCanvas::SfdpEngine;
+    m_scalableNodeThreshold = 0;
+    m_scalableEdgeThreshold = 0;
+    m_loadWatcher = Q_NULLPTR;
+    m_loadTimer = Q_NULLPTR;
+    m_loadNode = Q_NULLPTR;
+    m_loadedNodes = 0;
+    m_loadTotalNodes = 0;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    QObject::connect( q, &QGraphCanvas::layoutUpdated, q, &QGraphCanvas::handleLayoutUdated );
+    QObject::connect( q, &QGraphCanvas::selectionChanged, q, &QGraphCanvas::handleSelectionChanged );
+    QObject::connect( m_layoutWatcher, &QFutureWatcherBase::finished, q, &QGraphCanvas::handleLayoutFinished );
+#else
+    QObject::connect( q, SIGNAL(layoutUpdated()), q, SLOT(handleLayoutUdated()) );
+    QObject::connect( q, SIGNAL(selectionChanged()), q, SLOT(handleSelectionChanged()) );
+    QObject::connect( m_layoutWatcher, SIGNAL(finished()), q, SLOT(handleLayoutFinished()) );
+#endif
+}
+
+/**
+ * @brief QGraphCanvasPrivate::~QGraphCanvasPrivate
+ *
+ * Destroys the QGraphCanvasPrivate instance.  Any pending asynchronous layout is superseded and
+ * a running asynchronous layout is allowed to release the Graphviz context before returning.  Graphs
+ * still being parsed by an asynchronous load are waited for and closed.  The graph items are destroyed
+ * and the graph with its layout and the Graphviz context are freed.
+ */
+QGraphCanvasPrivate::~QGraphCanvasPrivate()
+{
+    nextGeneration();
+
+    // wait for the graphs still being parsed and discard them
+    foreach ( QFutureWatcher< Agraph_t* >* watcher, m_loadWatchers ) {
+        watcher->waitForFinished();
+        closeGraph( watcher->result() );
+    }
+
+    // the graph items refer to the libcgraph graph so they are destroyed before the graph is closed;
+    // no signals are emitted by the canvas being destroyed while its items are removed
+    q_ptr->blockSignals( true );
+    releaseGraph();
+
+    QMutexLocker locker( graphvizMutex() );
+
+    releaseContext( m_gvc );
+    m_gvc = Q_NULLPTR;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::acquireContext
+ * @return - the shared Graphviz context (NULL on failure)
+ *
+ * Returns the Graphviz context shared by all canvases creating it on first use, so that the Graphviz plugins are
+ * loaded and configured once rather than for every canvas.  Sharing a single context is sufficient since all use of
+ * the Graphviz library, including the layouts on worker threads, is serialized by the Graphviz library mutex.
+ */
+GVC_t* QGraphCanvasPrivate::acquireContext()
+{
+    QMutexLocker locker( graphvizMutex() );
+
+    if ( ! s_sharedContext )
+        s_sharedContext = gvContext();
+
+    if ( s_sharedContext )
+        s_sharedContextRefCount++;
+
+    return s_sharedContext;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::releaseContext
+ * @param gvc - the shared Graphviz context returned by acquireContext() (may be NULL)
+ *
+ * Releases a reference to the shared Graphviz context and frees the context when the last canvas releases it.
+ * The caller must hold the Graphviz library mutex.
+ */
+void QGraphCanvasPrivate::releaseContext(GVC_t *gvc)
+{
+    if ( ! gvc || gvc != s_sharedContext )
+        return;
+
+    if ( --s_sharedContextRefCount == 0 ) {
+        gvFreeContext( s_sharedContext );
+        s_sharedContext = NULL;
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphvizMutex
+ * @return - the process-wide mutex serializing access to the Graphviz library
+ *
+ * The Graphviz layout engines and the libcgraph parser use global state and therefore must not
+ * be entered concurrently from the GUI thread and the layout worker threads.
+ */
+QMutex* QGraphCanvasPrivate::graphvizMutex()
+{
+    return s_graphvizMutex();
+}
+
+// input channel of the libcgraph parser streaming DOT text either from a memory-mapped file or from a device
+struct DotReader {
+    QIODevice* device;
+    const char* data;
+    qint64 size;
+    qint64 pos;
+};
+
+static int dotReaderRead(void* chan, char* buf, int bufsize)
+{
+    DotReader* reader = static_cast< DotReader* >( chan );
+
+    if ( bufsize <= 0 )
+        return 0;
+
+    if ( reader->data ) {
+        // hand out at most one line at a time as the libcgraph memory reader does
+        const char* ptr = reader->data + reader->pos;
+        const qint64 available = reader->size - reader->pos;
+        int length = 0;
+        while ( length < available && length < bufsize ) {
+            if ( ptr[ length++ ] == '\n' )
+                break;
+        }
+        memcpy( buf, ptr, length );
+        reader->pos += length;
+        return length;
+    }
+
+    // QIODevice::readLine stores at most bufsize - 1 characters followed by a terminating NUL
+    qint64 length = reader->device->readLine( buf, bufsize );
+    while ( 0 == length && reader->device->isSequential() && reader->device->waitForReadyRead( 30000 ) ) {
+        length = reader->device->readLine( buf, bufsize );
+    }
+
+    return ( length > 0 ) ? (int) length : 0;
+}
+
+static int dotReaderPutStr(void* chan, const char* str)
+{
+    return fputs( str, static_cast< FILE* >( chan ) );
+}
+
+static int dotReaderFlush(void* chan)
+{
+    return fflush( static_cast< FILE* >( chan ) );
+}
+
+// NOTE: the graph retains the I/O discipline so it must outlive every graph read with it
+static Agiodisc_t s_dotReaderIoDisc = { dotReaderRead, dotReaderPutStr, dotReaderFlush };
+
+/**
+ * @brief QGraphCanvasPrivate::readGraph
+ * @param device - the device from which the DOT formatted graph is read
+ * @return - the graph read (NULL on failure)
+ *
+ * Parses a DOT formatted graph streamed from the device through a custom libcgraph I/O discipline so the DOT text
+ * is never copied into a single memory buffer.  A QFile is memory-mapped when possible and handed to the parser line
+ * by line; otherwise the device is read a line at a time, waiting for more data on sequential devices.  The device is
+ * opened for reading if it is not open yet and closed again afterwards.
+ */
+Agraph_t* QGraphCanvasPrivate::readGraph(QIODevice *device)
+{
+    if ( ! device ) {
+        qCritical() << "ERROR: Unable to read graph from NULL device";
+        return Q_NULLPTR;
+    }
+
+    const bool wasOpen = device->isOpen();
+    if ( ! wasOpen && ! device->open( QIODevice::ReadOnly ) ) {
+        qCritical() << "ERROR: Unable to open device to read graph:" << device->errorString();
+        return Q_NULLPTR;
+    }
+
+    DotReader reader;
+    reader.device = device;
+    reader.data = Q_NULLPTR;
+    reader.size = 0;
+    reader.pos = 0;
+
+    QFile* file = qobject_cast< QFile* >( device );
+    uchar* mapped = Q_NULLPTR;
+    if ( file && ! file->isSequential() && file->size() > file->pos() ) {
+        mapped = file->map( file->pos(), file->size() - file->pos() );
+        if ( mapped ) {
+            reader.data = reinterpret_cast< const char* >( mapped );
+            reader.size = file->size() - file->pos();
+        }
+    }
+
+    Agdisc_t disc = { &AgMemDisc, &AgIdDisc, &s_dotReaderIoDisc };
+
+    Agraph_t* graph = Q_NULLPTR;
+
+    {
+        // the libcgraph parser is not reentrant
+        QMutexLocker locker( graphvizMutex() );
+        graph = agread( &reader, &disc );
+    }
+
+    if ( mapped ) {
+        file->seek( file->pos() + reader.pos );
+        file->unmap( mapped );
+    }
+
+    if ( ! wasOpen )
+        device->close();
+
+    if ( ! graph )
+        qCritical() << "ERROR: Unable to read graph from device";
+
+    return graph;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::logicalDpiY
+ * @return - the logical DPI Y of the desktop
+ *
+ * Returns the logical DPI Y of the desktop used to scale the node and edge label fonts.  This method must be invoked from the GUI thread.
+ */
+int QGraphCanvasPrivate::logicalDpiY()
+{
+    QDesktopWidget* desktopWidget = QApplication::desktop();
+    return ( desktopWidget ) ? desktopWidget->logicalDpiY() : 96;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::labelFont
+ * @param fontName - the Graphviz font name of the label
+ * @param pixelSize - the pixel size of the label font
+ * @return - the label font
+ *
+ * Returns the label font for the given font name and pixel size.  The fonts are cached and shared by all canvases, so that
+ * the node and edge labels using the same font share a single QFont instance.  This method may be invoked from worker threads.
+ */
+QFont QGraphCanvasPrivate::labelFont(const QString &fontName, int pixelSize)
+{
+    const QPair< QString, int > key( fontName, pixelSize );
+
+    QMutexLocker locker( s_labelFontCacheMutex() );
+
+    LabelFontCache::const_iterator iter = s_labelFontCache()->constFind( key );
+
+    if ( iter != s_labelFontCache()->constEnd() )
+        return *iter;
+
+    QFont font( fontName );
+    font.setPixelSize( pixelSize );
+
+    s_labelFontCache()->insert( key, font );
+
+    return font;
+}
+
 /**
  * @brief QGraphCanvasPrivate::graph
  * @return - the underlying libcgraph graph instance
@@ -111,6 +493,235 @@ Agraph_t* QGraphCanvasPrivate::graph() const
     return m_graph;
 }
 
+/**
+ * @brief QGraphCanvasPrivate::attributeSymbol
+ * @param graph - the libcgraph graph instance
+ * @param symbol - the well-known attribute symbol
+ * @return - the attribute symbol (NULL if the attribute is not declared)
+ *
+ * Returns a well-known attribute symbol of the root graph.  The symbols are looked up once and then cached in a record
+ * bound to the root graph, so that snapshots of the graph laid out on worker threads have their own cache.  Symbols of
+ * undeclared attributes are looked up again since the attribute may be declared later.  This method must be serialized
+ * with all other accesses to the graph.
+ */
+Agsym_t* QGraphCanvasPrivate::attributeSymbol(Agraph_t *graph, AttributeSymbol symbol)
+{
+    if ( ! graph )
+        return Q_NULLPTR;
+
+    Agraph_t* root = agroot( graph );
+
+    SymbolRecord* record = (SymbolRecord*) aggetrec( root, const_cast< char* >( SYMBOL_RECORD_NAME ), FALSE );
+    if ( ! record )
+        record = (SymbolRecord*) agbindrec( root, const_cast< char* >( SYMBOL_RECORD_NAME ), sizeof(SymbolRecord), FALSE );
+
+    if ( ! record->symbols[ symbol ] )
+        record->symbols[ symbol ] = agattr( root, SYMBOL_KINDS[ symbol ], const_cast< char* >( SYMBOL_NAMES[ symbol ] ), NULL );
+
+    return record->symbols[ symbol ];
+}
+
+/**
+ * @brief QGraphCanvasPrivate::attributeSymbol
+ * @param graph - the libcgraph graph instance
+ * @param kind - the kind of the attribute (AGRAPH, AGNODE or AGEDGE)
+ * @param name - the name of the attribute
+ * @param create - whether to declare the attribute with an empty default value if not declared yet
+ * @return - the attribute symbol (NULL if the attribute is not declared)
+ *
+ * Looks up the named attribute symbol of the root graph.
+ */
+Agsym_t* QGraphCanvasPrivate::attributeSymbol(Agraph_t *graph, int kind, const QByteArray &name, bool create)
+{
+    if ( ! graph )
+        return Q_NULLPTR;
+
+    Agraph_t* root = agroot( graph );
+
+    QByteArray attributeName( name );
+
+    Agsym_t* symbol = agattr( root, kind, attributeName.data(), NULL );
+
+    if ( ! symbol && create )
+        symbol = agattr( root, kind, attributeName.data(), const_cast< char* >( "" ) );
+
+    return symbol;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::attributeSymbol
+ * @param kind - the kind of the attribute (AGRAPH, AGNODE or AGEDGE)
+ * @param name - the name of the attribute
+ * @param create - whether to declare the attribute with an empty default value if not declared yet
+ * @return - the attribute symbol (NULL if the attribute is not declared)
+ *
+ * Returns the named attribute symbol of the graph of the canvas.  The symbol is looked up once and then cached
+ * by name until the graph is replaced.
+ */
+Agsym_t* QGraphCanvasPrivate::attributeSymbol(int kind, const QString &name, bool create)
+{
+    QHash< QString, Agsym_t* >& symbols = m_attributeSymbols[ ( AGRAPH == kind ) ? 0 : ( AGNODE == kind ) ? 1 : 2 ];
+
+    Agsym_t* symbol = symbols.value( name );
+
+    if ( ! symbol ) {
+        symbol = attributeSymbol( m_graph, kind, name.toLocal8Bit(), create );
+        if ( symbol )
+            symbols.insert( name, symbol );
+    }
+
+    return symbol;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::attributeValue
+ * @param object - the libcgraph graph, node or edge instance
+ * @param symbol - the attribute symbol (may be NULL)
+ * @return - the attribute value (empty if the symbol is NULL)
+ */
+QString QGraphCanvasPrivate::attributeValue(void *object, Agsym_t *symbol)
+{
+    if ( ! object || ! symbol )
+        return QString();
+
+    return QString::fromLocal8Bit( agxget( object, symbol ) );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setAttributeValue
+ * @param object - the libcgraph graph, node or edge instance
+ * @param symbol - the attribute symbol (may be NULL)
+ * @param value - the attribute value in the local 8-bit encoding
+ */
+void QGraphCanvasPrivate::setAttributeValue(void *object, Agsym_t *symbol, const QByteArray &value)
+{
+    if ( ! object || ! symbol )
+        return;
+
+    QByteArray attributeValue( value );
+
+    agxset( object, symbol, attributeValue.data() );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setNodeAttributes
+ * @param attributeSettings - a list of nodes each with a list of name/value pairs specifying node attribute settings
+ *
+ * Sets the node attributes using the cached attribute symbols, updates the styles and colors of the nodes and repaints
+ * the united scene area of the changed nodes once.  Nodes not in the canvas and the summary nodes of collapsed clusters
+ * are skipped.
+ */
+void QGraphCanvasPrivate::setNodeAttributes(const QVector< QPair< QGraphNode*, QGraphCanvas::NameValueList > > &attributeSettings)
+{
+    Q_Q(QGraphCanvas);
+
+    QRectF dirtyRect;
+
+    for ( int i=0; i<attributeSettings.size(); i++ ) {
+        QGraphNode* node = attributeSettings[i].first;
+        if ( ! node || node->scene() != q || agroot( node->d_func()->node() ) != m_graph )
+            continue;
+
+        QGraphNodePrivate* d = node->d_func();
+
+        foreach ( const QGraphCanvas::NameValuePair& nameValuePair, attributeSettings[i].second ) {
+            setAttributeValue( d->node(), attributeSymbol( AGNODE, nameValuePair.first, true ), nameValuePair.second.toLocal8Bit() );
+        }
+
+        d->updatePaintState();
+
+        dirtyRect |= node->sceneBoundingRect();
+    }
+
+    if ( ! dirtyRect.isNull() )
+        q->update( dirtyRect );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setNodeColors
+ * @param nodes - the nodes to color
+ * @param values - the value of each node
+ * @param colorMap - the color map as gradient stops in the range [0, 1]
+ * @param minimum - the value mapped to the start of the color map
+ * @param maximum - the value mapped to the end of the color map
+ *
+ * Sets the "fillcolor" attribute of each node to the color mapped from its value and adds the "filled" style if missing.
+ * The styles and colors of the nodes are updated and the united scene area of the changed nodes is repainted once.
+ * Nodes not in the canvas and the summary nodes of collapsed clusters are skipped.
+ */
+void QGraphCanvasPrivate::setNodeColors(const QVector< QGraphNode* > &nodes, const QVector< qreal > &values,
+                                        const QGradientStops &colorMap, qreal minimum, qreal maximum)
+{
+    Q_Q(QGraphCanvas);
+
+    if ( nodes.size() != values.size() ) {
+        qWarning() << "WARNING: The number of node values does not match the number of nodes";
+    }
+
+    Agsym_t* fillColorSymbol = attributeSymbol( AGNODE, QStringLiteral("fillcolor"), true );
+    Agsym_t* styleSymbol = attributeSymbol( AGNODE, QStringLiteral("style"), true );
+
+    const qreal range = maximum - minimum;
+
+    QRectF dirtyRect;
+
+    const int count = qMin( nodes.size(), values.size() );
+    for ( int i=0; i<count; i++ ) {
+        QGraphNode* node = nodes[i];
+        if ( ! node || node->scene() != q || agroot( node->d_func()->node() ) != m_graph )
+            continue;
+
+        QGraphNodePrivate* d = node->d_func();
+
+        const qreal position = ( range > 0.0 ) ? ( values[i] - minimum ) / range : 0.0;
+        setAttributeValue( d->node(), fillColorSymbol, colorMapColor( colorMap, position ).name().toLatin1() );
+
+        if ( ! d->m_styles.contains( QGraphNodePrivate::Filled ) ) {
+            const QString style = attributeValue( d->node(), styleSymbol );
+            setAttributeValue( d->node(), styleSymbol, ( style.isEmpty() ? QStringLiteral("filled") : style + QStringLiteral(",filled") ).toLocal8Bit() );
+        }
+
+        d->updatePaintState();
+
+        dirtyRect |= node->sceneBoundingRect();
+    }
+
+    if ( ! dirtyRect.isNull() )
+        q->update( dirtyRect );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::colorMapColor
+ * @param colorMap - the color map as gradient stops in the range [0, 1]
+ * @param position - the position in the color map (clamped to [0, 1])
+ * @return - the color interpolated linearly between the neighboring gradient stops
+ */
+QColor QGraphCanvasPrivate::colorMapColor(const QGradientStops &colorMap, qreal position)
+{
+    if ( colorMap.isEmpty() )
+        return QColor();
+
+    position = qBound( qreal( 0.0 ), position, qreal( 1.0 ) );
+
+    if ( position <= colorMap.first().first )
+        return colorMap.first().second;
+
+    for ( int i=1; i<colorMap.size(); i++ ) {
+        if ( position <= colorMap[i].first ) {
+            const QGradientStop& from = colorMap[i-1];
+            const QGradientStop& to = colorMap[i];
+            const qreal span = to.first - from.first;
+            const qreal t = ( span > 0.0 ) ? ( position - from.first ) / span : 1.0;
+            return QColor::fromRgbF( from.second.redF() + t * ( to.second.redF() - from.second.redF() ),
+                                     from.second.greenF() + t * ( to.second.greenF() - from.second.greenF() ),
+                                     from.second.blueF() + t * ( to.second.blueF() - from.second.blueF() ),
+                                     from.second.alphaF() + t * ( to.second.alphaF() - from.second.alphaF() ) );
+        }
+    }
+
+    return colorMap.last().second;
+}
+
 /**
  * @brief QGraphCanvasPrivate::setGraphAttribute
  * @param name - the name of the graph attribute to set
@@ -154,45 +765,3540 @@ void QGraphCanvasPrivate::setEdgeAttribute(const QString &name, const QString &v
 }
 
 /**
- * @brief QGraphCanvasPrivate::showGrid
- * @param shown - specifies whether the grid will be drawn on the graph canvas
+ * @brief QGraphCanvasPrivate::createGraphItems
  *
- * Sets whether the grid will be drawn on the graph canvas.
+ * Creates and registers a graph item for every node and edge of the graph read at construction.
  */
-void QGraphCanvasPrivate::showGrid(bool shown)
+void QGraphCanvasPrivate::createGraphItems()
 {
-    m_drawGrid = shown;
+    if ( ! m_graph )
+        return;
+
+    initializeVisibility();
+
+    for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+        createGraphItems( node );
+    }
 }
 
 /**
- * @brief QGraphCanvasPrivate::updateLayout
+ * @brief QGraphCanvasPrivate::createGraphItems
+ * @param node - the libcgraph node instance
  *
- * Updates the layout of the graph canvas.
+ * Creates and registers the graph items of the node and of its out-edges.  The items of hidden nodes and of the
+ * edges to hidden nodes are deferred until the nodes are revealed.  Items already created when revealing nodes
+ * during an asynchronous load are kept.
  */
-void QGraphCanvasPrivate::updateLayout()
+void QGraphCanvasPrivate::createGraphItems(Agnode_t *node)
 {
-    if ( m_gvc && m_graph ) {
-        if ( 0 == gvLayout( m_gvc, m_graph, "dot" ) ) {
-            Q_Q(QGraphCanvas);
+    if ( m_hiddenNodes.contains( node ) || graphNode( node ) )
+        return;
+
+    QGraphNode* graphNode = new QGraphNode( node );
+    if ( ! addGraphNode( graphNode ) ) {
+        delete graphNode;
+        return;
+    }
+    q_ptr->addItem( graphNode );
+
+    const QVector< QString > keys = edgeKeys( m_graph, node );
 
-            emit q->layoutUpdated();
+    int i( 0 );
+    for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge), i++) {
+        if ( m_hiddenNodes.contains( aghead( edge ) ) || QGraphCanvasPrivate::graphEdge( edge ) )
+            continue;
+        QGraphEdge* graphEdge = new QGraphEdge( edge );
+        if ( ! addGraphEdge( graphEdge, keys[i] ) ) {
+            delete graphEdge;
+            continue;
         }
+        q_ptr->addItem( graphEdge );
     }
 }
 
 /**
- * @brief QGraphCanvasPrivate::setAttributes
+ * @brief QGraphCanvasPrivate::loadGraphAsync
+ * @param request - the load request
  * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
  * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
  * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
  *
- * Sets the default graph, node and edge attributes.
+ * Starts parsing the graph of the load request on a worker thread superseding any load still in progress.  As done
+ * by cancelLoad(), a superseded load already creating its items clears its partly itemized graph.  A busy indication
+ * is reported by emitting the loadProgress() signal with a zero maximum.
  */
-void QGraphCanvasPrivate::setAttributes(const QGraphCanvas::NameValueList &graphAttributeSettings,
-                                        const QGraphCanvas::NameValueList &nodeAttributeSettings,
-                                        const QGraphCanvas::NameValueList &edgeAttributeSettings)
+void QGraphCanvasPrivate::loadGraphAsync(const LoadRequest &request,
+                                         const QGraphCanvas::NameValueList& graphAttributeSettings,
+                                         const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                                         const QGraphCanvas::NameValueList& edgeAttributeSettings)
 {
-    // configure graph attributes
+    Q_Q(QGraphCanvas);
+
+    // supersede the load in progress; a graph still being parsed is closed when its parsing completes
+    const bool creatingItems = ( m_loadNode != Q_NULLPTR );
+
+    m_loadNode = Q_NULLPTR;
+    if ( m_loadTimer )
+        m_loadTimer->stop();
+
+    if ( creatingItems )
+        clearGraph();
+
+    m_loadGraphAttributes = graphAttributeSettings;
+    m_loadNodeAttributes = nodeAttributeSettings;
+    m_loadEdgeAttributes = edgeAttributeSettings;
+
+    m_loadWatcher = new QFutureWatcher< Agraph_t* >( q );
+    m_loadWatchers.append( m_loadWatcher );
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    QObject::connect( m_loadWatcher, &QFutureWatcherBase::finished, q, &QGraphCanvas::handleGraphLoaded );
+#else
+    QObject::connect( m_loadWatcher, SIGNAL(finished()), q, SLOT(handleGraphLoaded()) );
+#endif
+
+    m_loadWatcher->setFuture( QtConcurrent::run( &QGraphCanvasPrivate::loadGraph, request ) );
+
+    emit q->loadProgress( 0, 0 );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::cancelLoad
+ *
+ * Cancels the asynchronous load in progress, if any.  A graph still being parsed is discarded and the current graph is
+ * kept.  Once parsed the loaded graph has replaced the current graph, so cancelling while its items are being created
+ * clears the graph instead of leaving it with the items of only some of its nodes.
+ */
+void QGraphCanvasPrivate::cancelLoad()
+{
+    Q_Q(QGraphCanvas);
+
+    if ( ! isLoading() )
+        return;
+
+    const bool creatingItems = ( m_loadNode != Q_NULLPTR );
+
+    m_loadWatcher = Q_NULLPTR;
+    m_loadNode = Q_NULLPTR;
+    if ( m_loadTimer )
+        m_loadTimer->stop();
+
+    if ( creatingItems )
+        clearGraph();
+
+    emit q->loadFinished( false );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::isLoading
+ * @return - whether a graph is being parsed or its graph items are being created
+ */
+bool QGraphCanvasPrivate::isLoading() const
+{
+    return m_loadWatcher || m_loadNode;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::loadGraph
+ * @param request - the load request
+ * @return - the graph parsed (NULL on failure)
+ *
+ * Worker thread function parsing the graph of the load request.
+ */
+Agraph_t* QGraphCanvasPrivate::loadGraph(const LoadRequest &request)
+{
+    if ( ! request.fileName.isEmpty() ) {
+        QFile file( request.fileName );
+        return readGraph( &file );
+    }
+
+    QBuffer buffer;
+    buffer.setData( request.data );
+
+    return readGraph( &buffer );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::handleGraphLoaded
+ * @param watcher - the watcher of the worker thread that parsed the graph
+ *
+ * Replaces the current graph by the graph parsed on the worker thread and starts creating its graph items in time
+ * slices.  The parsed graph is discarded if the load has been superseded or cancelled in the meantime.
+ */
+void QGraphCanvasPrivate::handleGraphLoaded(QFutureWatcher< Agraph_t* >* watcher)
+{
+    Q_Q(QGraphCanvas);
+
+    Agraph_t* graph = watcher->result();
+
+    m_loadWatchers.removeOne( watcher );
+    watcher->deleteLater();
+
+    if ( watcher != m_loadWatcher ) {
+        closeGraph( graph );
+        return;
+    }
+
+    m_loadWatcher = Q_NULLPTR;
+
+    if ( ! graph ) {
+        emit q->loadFinished( false );
+        return;
+    }
+
+    releaseGraph();
+
+    m_graph = graph;
+
+    setAttributes( m_loadGraphAttributes, m_loadNodeAttributes, m_loadEdgeAttributes );
+
+    if ( ! m_loadTimer ) {
+        m_loadTimer = new QTimer( q );
+        m_loadTimer->setSingleShot( true );
+        m_loadTimer->setInterval( 0 );
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+        QObject::connect( m_loadTimer, &QTimer::timeout, q, &QGraphCanvas::handleGraphItemCreation );
+#else
+        QObject::connect( m_loadTimer, SIGNAL(timeout()), q, SLOT(handleGraphItemCreation()) );
+#endif
+    }
+
+    initializeVisibility();
+
+    m_loadNode = agfstnode( m_graph );
+    m_loadedNodes = 0;
+    m_loadTotalNodes = agnnodes( m_graph );
+
+    createGraphItemsSlice();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::createGraphItemsSlice
+ *
+ * Creates the graph items of the graph being loaded for one time slice and reports the progress.  The next time slice
+ * is scheduled after the pending events have been processed until the items of all nodes have been created.
+ */
+void QGraphCanvasPrivate::createGraphItemsSlice()
+{
+    Q_Q(QGraphCanvas);
+
+    if ( ! m_loadNode )
+        return;
+
+    QElapsedTimer timer;
+    timer.start();
+
+    while ( m_loadNode && ! timer.hasExpired( LOAD_TIME_SLICE ) ) {
+        createGraphItems( m_loadNode );
+        m_loadNode = agnxtnode( m_graph, m_loadNode );
+        ++m_loadedNodes;
+    }
+
+    emit q->loadProgress( m_loadedNodes, m_loadTotalNodes );
+
+    if ( m_loadNode ) {
+        m_loadTimer->start();
+    }
+    else {
+        emit q->loadFinished( true );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::releaseGraph
+ *
+ * Destroys all graph items and closes the graph.  Any pending asynchronous layout of the graph is superseded.
+ */
+void QGraphCanvasPrivate::releaseGraph()
+{
+    nextGeneration();
+
+    QList< QGraphicsObject* > items;
+
+    for ( QHash< QString, QPointer< QGraphEdge > >::const_iterator i = m_edgeItems.constBegin(); i != m_edgeItems.constEnd(); ++i ) {
+        if ( ! i.value().isNull() )
+            items.append( i.value().data() );
+    }
+
+    for ( QHash< QString, QPointer< QGraphNode > >::const_iterator i = m_nodeItems.constBegin(); i != m_nodeItems.constEnd(); ++i ) {
+        if ( ! i.value().isNull() )
+            items.append( i.value().data() );
+    }
+
+    qDeleteAll( items );
+
+    m_nodeItems.clear();
+    m_edgeItems.clear();
+    m_edgeItemsByNodes.clear();
+    m_pendingNodes.clear();
+    m_pendingEdges.clear();
+    m_collapsedNodes.clear();
+    m_unreachedNodes.clear();
+    m_collapsedClusters.clear();
+    m_clusterNodes.clear();
+    m_hiddenNodes.clear();
+    m_summaryNodes.clear();
+    m_boundingBox = QRectF();
+    invalidateItemIndex();
+
+    for ( int i=0; i<3; i++ ) {
+        m_attributeSymbols[i].clear();
+    }
+
+    if ( m_graph ) {
+        QMutexLocker locker( graphvizMutex() );
+        freeLayout();
+        agclose( m_graph );
+        m_graph = Q_NULLPTR;
+        if ( m_summaryGraph ) {
+            agclose( m_summaryGraph );
+            m_summaryGraph = Q_NULLPTR;
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::freeLayout
+ *
+ * Frees the layout data attached to the graph by the most recent synchronous layout, if any.  The caller must hold
+ * the Graphviz library mutex.
+ */
+void QGraphCanvasPrivate::freeLayout()
+{
+    if ( m_gvc && m_graph && m_graphLaidOut ) {
+        gvFreeLayout( m_gvc, m_graph );
+        m_graphLaidOut = false;
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::clearGraph
+ *
+ * Destroys all graph items and replaces the graph by an empty graph of the same name and kind.  The attribute
+ * declarations, and thus the default attribute values, of the graph are kept.  The Graphviz context is reused.
+ */
+void QGraphCanvasPrivate::clearGraph()
+{
+    cancelLoad();
+
+    Agraph_t* graph( Q_NULLPTR );
+
+    if ( m_graph ) {
+        QMutexLocker locker( graphvizMutex() );
+        graph = agopen( agnameof( m_graph ), m_graph->desc, NULL );
+        if ( graph )
+            cloneAttributeDeclarations( m_graph, graph );
+    }
+
+    releaseGraph();
+
+    m_graph = graph;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::reloadGraph
+ * @param device - the device from which the DOT formatted graph is read
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ * @return - whether the graph was read successfully
+ *
+ * Replaces the graph and all its items by the DOT formatted graph read from the device.  The current graph is kept if
+ * the graph cannot be read.  The Graphviz context is reused.
+ */
+bool QGraphCanvasPrivate::reloadGraph(QIODevice *device,
+                                      const QGraphCanvas::NameValueList& graphAttributeSettings,
+                                      const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                                      const QGraphCanvas::NameValueList& edgeAttributeSettings)
+{
+    cancelLoad();
+
+    Agraph_t* graph = readGraph( device );
+
+    if ( ! graph )
+        return false;
+
+    releaseGraph();
+
+    m_graph = graph;
+
+    createGraphItems();
+
+    // set default attributes
+    setAttributes( graphAttributeSettings, nodeAttributeSettings, edgeAttributeSettings );
+
+    return true;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::closeGraph
+ * @param graph - the libcgraph graph instance (may be NULL)
+ *
+ * Closes the graph and frees all its memory.
+ */
+void QGraphCanvasPrivate::closeGraph(Agraph_t *graph)
+{
+    if ( graph ) {
+        QMutexLocker locker( graphvizMutex() );
+        agclose( graph );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::addGraphNode
+ * @param node - the QGraphNode instance added to the graph canvas
+ * @return - whether the node has been registered
+ *
+ * Registers the node with the canvas and indexes it by name and by its libcgraph node.  The node is pending until it is laid out.
+ * A second item for a node which already has an item is rejected since the node is indexed by its name.
+ */
+bool QGraphCanvasPrivate::addGraphNode(QGraphNode *node)
+{
+    const QString key = QString::fromLocal8Bit( agnameof( node->d_func()->node() ) );
+
+    QGraphNode* graphNode = m_nodeItems.value( key );
+
+    if ( graphNode && graphNode != node ) {
+        qWarning() << "WARNING: Graph node '" << key << "' already has a graph item on the canvas";
+        return false;
+    }
+
+    bindItem( node->d_func()->node(), node );
+
+    m_nodeItems.insert( key, node );
+    m_pendingNodes.append( key );
+
+    return true;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::addGraphEdge
+ * @param edge - the QGraphEdge instance added to the graph canvas
+ * @return - whether the edge has been registered
+ *
+ * Registers the edge with the canvas and indexes it by its libcgraph edge.  The edge is pending until it is laid out.
+ */
+bool QGraphCanvasPrivate::addGraphEdge(QGraphEdge *edge)
+{
+    return addGraphEdge( edge, edgeKey( edge->d_func()->m_edge ) );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::addGraphEdge
+ * @param edge - the QGraphEdge instance added to the graph canvas
+ * @param key - the key of the edge as returned by edgeKey()
+ * @return - whether the edge has been registered
+ *
+ * Registers the edge with the canvas under the given key and indexes it by its libcgraph edge and by its tail and head
+ * nodes.  A second item for an edge which already has an item is rejected.
+ */
+bool QGraphCanvasPrivate::addGraphEdge(QGraphEdge *edge, const QString &key)
+{
+    QGraphEdge* graphEdge = m_edgeItems.value( key );
+
+    if ( graphEdge && graphEdge != edge ) {
+        qWarning() << "WARNING: Graph edge '" << key << "' already has a graph item on the canvas";
+        return false;
+    }
+
+    Agedge_t* e = edge->d_func()->m_edge;
+
+    bindItem( e, edge );
+
+    if ( graphEdge != edge )
+        m_edgeItemsByNodes.insert( qMakePair( agtail( e ), aghead( e ) ), edge );
+
+    m_edgeItems.insert( key, edge );
+    m_pendingEdges.append( key );
+
+    return true;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphNode
+ * @param name - the name of the node
+ * @return - the QGraphNode instance with the given name (NULL if there is no such node)
+ *
+ * Looks up the node by name.
+ */
+QGraphNode* QGraphCanvasPrivate::graphNode(const QString &name) const
+{
+    return m_nodeItems.value( name );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphEdges
+ * @param tail - the tail node of the edges
+ * @param head - the head node of the edges
+ * @return - the QGraphEdge instances from the tail node to the head node
+ *
+ * Looks up the graphics items of the edges from the tail node to the head node in the index of the edge items by their
+ * tail and head nodes.  The edges are returned in the order in which their items were added.
+ */
+QList< QGraphEdge* > QGraphCanvasPrivate::graphEdges(QGraphNode *tail, QGraphNode *head) const
+{
+    QList< QGraphEdge* > edges;
+
+    if ( m_graph && tail && head ) {
+        const QList< QPointer< QGraphEdge > > items = m_edgeItemsByNodes.values( qMakePair( tail->d_func()->node(), head->d_func()->node() ) );
+        // the values of a multi-hash key are listed from the most recently inserted one
+        for ( int i=items.size()-1; i>=0; i-- ) {
+            if ( ! items[i].isNull() )
+                edges.append( items[i].data() );
+        }
+    }
+
+    return edges;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphNode
+ * @param node - the libcgraph node instance
+ * @return - the QGraphNode instance of the libcgraph node (NULL if there is none)
+ *
+ * Returns the graphics item bound to the libcgraph node by addGraphNode().
+ */
+QGraphNode* QGraphCanvasPrivate::graphNode(Agnode_t *node)
+{
+    return static_cast< QGraphNode* >( boundItem( node ) );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphEdge
+ * @param edge - the libcgraph edge instance
+ * @return - the QGraphEdge instance of the libcgraph edge (NULL if there is none)
+ *
+ * Returns the graphics item bound to the libcgraph edge by addGraphEdge().
+ */
+QGraphEdge* QGraphCanvasPrivate::graphEdge(Agedge_t *edge)
+{
+    return static_cast< QGraphEdge* >( boundItem( edge ) );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::bindItem
+ * @param object - the libcgraph node or edge instance
+ * @param item - the graphics item of the libcgraph object
+ *
+ * Binds a record referring to the graphics item to the libcgraph object.  The record is not moved to the front
+ * of the record list since the Graphviz layout engines expect their own record there.
+ */
+void QGraphCanvasPrivate::bindItem(void *object, QGraphicsObject *item)
+{
+    ItemRecord* record = (ItemRecord*) agbindrec( object, const_cast< char* >( ITEM_RECORD_NAME ), sizeof( ItemRecord ), FALSE );
+
+    if ( record )
+        record->item = item;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::boundItem
+ * @param object - the libcgraph node or edge instance
+ * @return - the graphics item of the libcgraph object (NULL if there is none)
+ *
+ * Returns the graphics item referred to by the record bound to the libcgraph object.
+ */
+QGraphicsObject* QGraphCanvasPrivate::boundItem(void *object)
+{
+    ItemRecord* record = (ItemRecord*) aggetrec( object, const_cast< char* >( ITEM_RECORD_NAME ), FALSE );
+
+    return ( record ) ? record->item : Q_NULLPTR;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::unbindItem
+ * @param object - the libcgraph node or edge instance
+ * @param item - the graphics item being destroyed
+ *
+ * Clears the record bound to the libcgraph object if it still refers to the graphics item.
+ */
+void QGraphCanvasPrivate::unbindItem(void *object, QGraphicsObject *item)
+{
+    ItemRecord* record = (ItemRecord*) aggetrec( object, const_cast< char* >( ITEM_RECORD_NAME ), FALSE );
+
+    if ( record && record->item == item )
+        record->item = Q_NULLPTR;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::itemSelectionChanged
+ * @param node - the QGraphNode instance whose selection state changed
+ * @param selected - whether the node is now selected
+ *
+ * Records the selection change of the node for the next selectionDelta() signal.  Selecting and then deselecting
+ * the node before the signal is emitted cancels out.
+ */
+void QGraphCanvasPrivate::itemSelectionChanged(QGraphNode *node, bool selected)
+{
+    if ( selected ) {
+        if ( ! m_removedNodes.remove( node ) )
+            m_addedNodes.insert( node );
+    }
+    else {
+        if ( ! m_addedNodes.remove( node ) )
+            m_removedNodes.insert( node );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::itemSelectionChanged
+ * @param edge - the QGraphEdge instance whose selection state changed
+ * @param selected - whether the edge is now selected
+ *
+ * Records the selection change of the edge for the next selectionDelta() signal.  Selecting and then deselecting
+ * the edge before the signal is emitted cancels out.
+ */
+void QGraphCanvasPrivate::itemSelectionChanged(QGraphEdge *edge, bool selected)
+{
+    if ( selected ) {
+        if ( ! m_removedEdges.remove( edge ) )
+            m_addedEdges.insert( edge );
+    }
+    else {
+        if ( ! m_addedEdges.remove( edge ) )
+            m_removedEdges.insert( edge );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::itemDestroyed
+ * @param node - the QGraphNode instance being destroyed
+ *
+ * Removes the node from the index and discards its pending selection changes so that destroyed nodes are never
+ * reported by selectionDelta().
+ */
+void QGraphCanvasPrivate::itemDestroyed(QGraphNode *node)
+{
+    unbindItem( node->d_func()->node(), node );
+    invalidateItemIndex();
+
+    m_addedNodes.remove( node );
+    m_removedNodes.remove( node );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::itemDestroyed
+ * @param edge - the QGraphEdge instance being destroyed
+ *
+ * Removes the edge from the index and discards its pending selection changes so that destroyed edges are never
+ * reported by selectionDelta().
+ */
+void QGraphCanvasPrivate::itemDestroyed(QGraphEdge *edge)
+{
+    unbindItem( edge->d_func()->m_edge, edge );
+    invalidateItemIndex();
+
+    m_addedEdges.remove( edge );
+    m_removedEdges.remove( edge );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::emitSelectionDelta
+ *
+ * Emits the selectionDelta() signal with the selection changes recorded since the last signal, if any.
+ */
+void QGraphCanvasPrivate::emitSelectionDelta()
+{
+    Q_Q(QGraphCanvas);
+
+    if ( m_addedNodes.isEmpty() && m_removedNodes.isEmpty() && m_addedEdges.isEmpty() && m_removedEdges.isEmpty() )
+        return;
+
+    const QList< QGraphNode* > addedNodes = m_addedNodes.toList();
+    const QList< QGraphNode* > removedNodes = m_removedNodes.toList();
+    const QList< QGraphEdge* > addedEdges = m_addedEdges.toList();
+    const QList< QGraphEdge* > removedEdges = m_removedEdges.toList();
+
+    m_addedNodes.clear();
+    m_removedNodes.clear();
+    m_addedEdges.clear();
+    m_removedEdges.clear();
+
+    emit q->selectionDelta( addedNodes, removedNodes, addedEdges, removedEdges );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::showGrid
+ * @param shown - specifies whether the grid will be drawn on the graph canvas
+ *
+ * Sets whether the grid will be drawn on the graph canvas.
+ */
+void QGraphCanvasPrivate::showGrid(bool shown)
+{
+    m_drawGrid = shown;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::paintGrid
+ * @param painter - the scene painter instance to be used for drawing the background
+ * @param exposedRect - the exposed rectangle within the scene
+ *
+ * Draws the grid lines within the exposed part of the scene rectangle.  The grid spacing is doubled until the grid lines
+ * are at least MIN_GRID_PIXEL_SPACING device pixels apart, so that zooming out does not draw ever more lines.  The grid
+ * lines are either drawn with a single QPainter::drawLines() call or, if the grid is cached, by filling the exposed
+ * rectangle with a brush tiling a cached pixmap of one grid cell in device pixels.
+ */
+void QGraphCanvasPrivate::paintGrid(QPainter *painter, const QRectF &exposedRect)
+{
+    Q_Q(QGraphCanvas);
+
+    const QRectF sceneRect = q->sceneRect();
+    const QRectF gridRect = sceneRect.intersected( exposedRect );
+
+    const qreal scale = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+
+    if ( gridRect.isEmpty() || scale <= 0.0 )
+        return;
+
+    qreal spacing = GRID_SPACING;
+    while ( spacing * scale < MIN_GRID_PIXEL_SPACING ) {
+        spacing *= 2.0;
+    }
+
+    const QColor gridColor( qRgb(240, 240, 240) );
+
+    if ( m_gridCached ) {
+        // one grid cell in device pixels with the grid lines along its top and left edges
+        const int tileSize = qMax( 1, qRound( spacing * scale ) );
+
+        if ( m_gridTile.width() != tileSize ) {
+            m_gridTile = QPixmap( tileSize, tileSize );
+            m_gridTile.fill( Qt::transparent );
+            QPainter tilePainter( &m_gridTile );
+            tilePainter.setPen( gridColor );
+            tilePainter.drawLine( 0, 0, tileSize - 1, 0 );
+            tilePainter.drawLine( 0, 0, 0, tileSize - 1 );
+        }
+
+        // align the tiles with the scene rectangle origin and map the tile pixels to device pixels
+        QBrush brush( m_gridTile );
+        brush.setTransform( QTransform().translate( sceneRect.left(), sceneRect.top() ).scale( spacing / tileSize, spacing / tileSize ) );
+
+        painter->fillRect( gridRect, brush );
+    }
+    else {
+        // grid lines aligned with the scene rectangle origin
+        const qreal left = sceneRect.left() + std::ceil( ( gridRect.left() - sceneRect.left() ) / spacing ) * spacing;
+        const qreal top = sceneRect.top() + std::ceil( ( gridRect.top() - sceneRect.top() ) / spacing ) * spacing;
+
+        QVector< QLineF > lines;
+        lines.reserve( int( gridRect.width() / spacing ) + int( gridRect.height() / spacing ) + 2 );
+
+        for ( qreal x = left; x <= gridRect.right(); x += spacing ) {
+            lines.append( QLineF( x, gridRect.top(), x, gridRect.bottom() ) );
+        }
+
+        for ( qreal y = top; y <= gridRect.bottom(); y += spacing ) {
+            lines.append( QLineF( gridRect.left(), y, gridRect.right(), y ) );
+        }
+
+        painter->setPen( QPen( gridColor ) );
+        painter->drawLines( lines );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setLevelOfDetailThresholds
+ * @param labelThreshold - the level of detail below which node and edge labels are not drawn
+ * @param shapeThreshold - the level of detail below which nodes and edges are drawn in simplified form
+ *
+ * Sets the level of detail thresholds used by the nodes and edges when painting.
+ */
+void QGraphCanvasPrivate::setLevelOfDetailThresholds(qreal labelThreshold, qreal shapeThreshold)
+{
+    m_labelLevelOfDetailThreshold = labelThreshold;
+    m_shapeLevelOfDetailThreshold = shapeThreshold;
+}
+
+/**
+ * @brief cellRange
+ * @param index - the static item index
+ * @param rect - the scene rectangle (may be empty to look up a point)
+ * @param left - returns the first column of cells overlapping the rectangle
+ * @param top - returns the first row of cells overlapping the rectangle
+ * @param right - returns the last column of cells overlapping the rectangle
+ * @param bottom - returns the last row of cells overlapping the rectangle
+ * @return - whether the rectangle overlaps the bounds of the index
+ */
+static bool cellRange(const QGraphCanvasPrivate::ItemIndex& index, const QRectF& rect, int& left, int& top, int& right, int& bottom)
+{
+    if ( index.columns == 0 || rect.right() < index.bounds.left() || rect.left() > index.bounds.right() ||
+         rect.bottom() < index.bounds.top() || rect.top() > index.bounds.bottom() )
+        return false;
+
+    left = qBound( 0, int( std::floor( ( rect.left() - index.bounds.left() ) / index.cellSize.width() ) ), index.columns - 1 );
+    right = qBound( 0, int( std::floor( ( rect.right() - index.bounds.left() ) / index.cellSize.width() ) ), index.columns - 1 );
+    top = qBound( 0, int( std::floor( ( rect.top() - index.bounds.top() ) / index.cellSize.height() ) ), index.rows - 1 );
+    bottom = qBound( 0, int( std::floor( ( rect.bottom() - index.bounds.top() ) / index.cellSize.height() ) ), index.rows - 1 );
+
+    return true;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setStaticItemIndex
+ * @param enabled - whether the nodes and edges are indexed once after each layout
+ */
+void QGraphCanvasPrivate::setStaticItemIndex(bool enabled)
+{
+    m_staticItemIndex = enabled;
+
+    invalidateItemIndex();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::invalidateItemIndex
+ *
+ * Discards the static item index after nodes or edges have been added, removed or changed geometry.  The index is
+ * rebuilt after the next layout or on the next query.
+ */
+void QGraphCanvasPrivate::invalidateItemIndex()
+{
+    m_itemIndex = ItemIndex();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::buildItemIndex
+ *
+ * Builds the static item index from the scene bounding rectangles of the visible nodes and edges.  The bounds of the
+ * graph are divided into a uniform grid of about ITEMS_PER_INDEX_CELL items per cell whose item lists are packed in
+ * one array, so that a query touches only the cells overlapping the query rectangle.
+ */
+void QGraphCanvasPrivate::buildItemIndex() const
+{
+    Q_Q(const QGraphCanvas);
+
+    ItemIndex index;
+
+    // the items are indexed in ascending stacking order so that the cell item lists are sorted by stacking order
+    foreach ( QGraphicsItem* item, q->items( Qt::AscendingOrder ) ) {
+        if ( ( item->type() != QGraphNode::Type && item->type() != QGraphEdge::Type ) || ! item->isVisible() )
+            continue;
+        const QRectF rect = item->sceneBoundingRect();
+        index.items.append( item );
+        index.itemRects.append( rect );
+        index.bounds |= rect;
+    }
+
+    index.valid = true;
+
+    if ( index.items.isEmpty() || index.bounds.width() <= 0.0 || index.bounds.height() <= 0.0 ) {
+        m_itemIndex = index;
+        return;
+    }
+
+    // choose the grid dimensions following the aspect ratio of the graph bounds
+    const int cellCount = qBound( 1, index.items.size() / ITEMS_PER_INDEX_CELL, MAX_INDEX_CELLS );
+    const qreal aspectRatio = index.bounds.width() / index.bounds.height();
+    index.columns = qBound( 1, qRound( std::sqrt( cellCount * aspectRatio ) ), cellCount );
+    index.rows = qMax( 1, ( cellCount + index.columns - 1 ) / index.columns );
+    index.cellSize = QSizeF( index.bounds.width() / index.columns, index.bounds.height() / index.rows );
+
+    // count the items overlapping each cell and convert the counts to cell offsets
+    index.cellOffsets.fill( 0, index.columns * index.rows + 1 );
+
+    int left, top, right, bottom;
+    for ( int i=0; i<index.items.size(); i++ ) {
+        cellRange( index, index.itemRects[i], left, top, right, bottom );
+        for ( int y=top; y<=bottom; y++ ) {
+            for ( int x=left; x<=right; x++ ) {
+                index.cellOffsets[ y * index.columns + x + 1 ]++;
+            }
+        }
+    }
+
+    for ( int cell=0; cell<index.columns * index.rows; cell++ ) {
+        index.cellOffsets[ cell + 1 ] += index.cellOffsets[ cell ];
+    }
+
+    // fill the packed cell item lists
+    index.cellItems.resize( index.cellOffsets.last() );
+
+    QVector< int > cellEnds( index.cellOffsets );
+    for ( int i=0; i<index.items.size(); i++ ) {
+        cellRange( index, index.itemRects[i], left, top, right, bottom );
+        for ( int y=top; y<=bottom; y++ ) {
+            for ( int x=left; x<=right; x++ ) {
+                index.cellItems[ cellEnds[ y * index.columns + x ]++ ] = i;
+            }
+        }
+    }
+
+    m_itemIndex = index;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphItems
+ * @param rect - the scene rectangle
+ * @return - the nodes and edges whose bounding rectangles intersect the rectangle in ascending stacking order
+ *
+ * Looks up the nodes and edges in the static item index when enabled, otherwise in the scene index.
+ */
+QList< QGraphicsItem* > QGraphCanvasPrivate::graphItems(const QRectF &rect) const
+{
+    Q_Q(const QGraphCanvas);
+
+    QList< QGraphicsItem* > items;
+
+    if ( ! m_staticItemIndex ) {
+        foreach ( QGraphicsItem* item, q->items( rect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder ) ) {
+            if ( item->type() == QGraphNode::Type || item->type() == QGraphEdge::Type )
+                items.append( item );
+        }
+        return items;
+    }
+
+    if ( ! m_itemIndex.valid )
+        buildItemIndex();
+
+    int left, top, right, bottom;
+    if ( ! cellRange( m_itemIndex, rect, left, top, right, bottom ) )
+        return items;
+
+    QVector< int > candidates;
+    for ( int y=top; y<=bottom; y++ ) {
+        for ( int x=left; x<=right; x++ ) {
+            const int cell = y * m_itemIndex.columns + x;
+            for ( int i=m_itemIndex.cellOffsets[ cell ]; i<m_itemIndex.cellOffsets[ cell + 1 ]; i++ ) {
+                candidates.append( m_itemIndex.cellItems[i] );
+            }
+        }
+    }
+
+    // items overlapping several cells are reported once
+    if ( left != right || top != bottom ) {
+        std::sort( candidates.begin(), candidates.end() );
+        candidates.erase( std::unique( candidates.begin(), candidates.end() ), candidates.end() );
+    }
+
+    foreach ( int i, candidates ) {
+        if ( m_itemIndex.itemRects[i].intersects( rect ) )
+            items.append( m_itemIndex.items[i] );
+    }
+
+    return items;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::graphItemAt
+ * @param pos - the scene position
+ * @return - the topmost node or edge whose shape contains the position (NULL if there is none)
+ *
+ * Looks up the node or edge in the static item index when enabled, otherwise in the scene index.
+ */
+QGraphicsItem* QGraphCanvasPrivate::graphItemAt(const QPointF &pos) const
+{
+    Q_Q(const QGraphCanvas);
+
+    if ( ! m_staticItemIndex ) {
+        foreach ( QGraphicsItem* item, q->items( pos, Qt::IntersectsItemShape, Qt::DescendingOrder ) ) {
+            if ( item->type() == QGraphNode::Type || item->type() == QGraphEdge::Type )
+                return item;
+        }
+        return Q_NULLPTR;
+    }
+
+    if ( ! m_itemIndex.valid )
+        buildItemIndex();
+
+    int left, top, right, bottom;
+    if ( ! cellRange( m_itemIndex, QRectF( pos, QSizeF( 0.0, 0.0 ) ), left, top, right, bottom ) )
+        return Q_NULLPTR;
+
+    // the cell item lists are in ascending stacking order so the topmost items are tested first
+    const int cell = top * m_itemIndex.columns + left;
+    for ( int i=m_itemIndex.cellOffsets[ cell + 1 ] - 1; i>=m_itemIndex.cellOffsets[ cell ]; i-- ) {
+        const int candidate = m_itemIndex.cellItems[i];
+        QGraphicsItem* item = m_itemIndex.items[ candidate ];
+        if ( m_itemIndex.itemRects[ candidate ].contains( pos ) && item->contains( item->mapFromScene( pos ) ) )
+            return item;
+    }
+
+    return Q_NULLPTR;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::bspTreeDepth
+ * @param itemCount - the number of items in the scene
+ * @return - the depth of the scene BSP tree giving about ITEMS_PER_BSP_LEAF items per leaf
+ *
+ * The BSP tree of depth N has 2^N leaves.  A fixed depth chosen once after layout avoids the scene adjusting the
+ * depth and rebuilding its index as the number of items grows.
+ */
+int QGraphCanvasPrivate::bspTreeDepth(int itemCount)
+{
+    int depth( 0 );
+
+    while ( depth < MAX_BSP_TREE_DEPTH && ( itemCount >> depth ) > ITEMS_PER_BSP_LEAF ) {
+        depth++;
+    }
+
+    return qMax( depth, MIN_BSP_TREE_DEPTH );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::collapseNode
+ * @param node - the QGraphNode instance of the canvas
+ *
+ * Collapses the subtree of the node.  The nodes only reachable through the node are hidden along with their edges.
+ * Only the subtree of the node and the in-edges of its nodes are traversed.  The positions of the remaining nodes are
+ * kept.
+ */
+void QGraphCanvasPrivate::collapseNode(QGraphNode *node)
+{
+    Q_Q(QGraphCanvas);
+
+    if ( ! m_graph || ! node || node->scene() != q )
+        return;
+
+    Agnode_t* n = node->d_func()->node();
+
+    // summary nodes are not part of the graph
+    if ( agroot( n ) != m_graph || m_collapsedNodes.contains( n ) )
+        return;
+
+    m_collapsedNodes.insert( n );
+
+    // the subtree of an unreached node is unreached already
+    if ( m_unreachedNodes.contains( n ) )
+        return;
+
+    // the reached nodes reachable from the node without passing through another collapsed node
+    QSet< Agnode_t* > subtree;
+    QList< Agnode_t* > queue;
+    queue.append( n );
+
+    for ( int i=0; i<queue.size(); i++ ) {
+        Agnode_t* tail = queue.at( i );
+        if ( i > 0 && m_collapsedNodes.contains( tail ) )
+            continue;
+        for (Agedge_t* edge = agfstout(m_graph, tail); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            Agnode_t* head = aghead( edge );
+            if ( head != n && ! m_unreachedNodes.contains( head ) && ! subtree.contains( head ) ) {
+                subtree.insert( head );
+                queue.append( head );
+            }
+        }
+    }
+
+    // the nodes of the subtree with an in-edge from a reached node outside the subtree remain reached along with the
+    // nodes reachable from them
+    QSet< Agnode_t* > reached;
+    queue.clear();
+
+    foreach( Agnode_t* s, subtree ) {
+        for (Agedge_t* edge = agfstin(m_graph, s); edge != NULL; edge = agnxtin(m_graph, edge)) {
+            Agnode_t* tail = agtail( edge );
+            if ( tail != n && ! subtree.contains( tail ) && ! m_unreachedNodes.contains( tail ) && ! m_collapsedNodes.contains( tail ) ) {
+                reached.insert( s );
+                queue.append( s );
+                break;
+            }
+        }
+    }
+
+    for ( int i=0; i<queue.size(); i++ ) {
+        Agnode_t* tail = queue.at( i );
+        if ( m_collapsedNodes.contains( tail ) )
+            continue;
+        for (Agedge_t* edge = agfstout(m_graph, tail); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            Agnode_t* head = aghead( edge );
+            if ( subtree.contains( head ) && ! reached.contains( head ) ) {
+                reached.insert( head );
+                queue.append( head );
+            }
+        }
+    }
+
+    QList< Agnode_t* > unreached;
+
+    foreach( Agnode_t* s, subtree ) {
+        if ( ! reached.contains( s ) ) {
+            m_unreachedNodes.insert( s );
+            unreached.append( s );
+        }
+    }
+
+    hideGraphItems( unreached );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::expandNode
+ * @param node - the QGraphNode instance of the canvas
+ *
+ * Expands the collapsed subtree of the node.  When an expansion depth is set only that many levels of the subtree
+ * are revealed.  Only the revealed nodes are traversed.  The revealed nodes and edges are placed by an incremental
+ * layout if the graph has been laid out.
+ */
+void QGraphCanvasPrivate::expandNode(QGraphNode *node)
+{
+    Q_Q(QGraphCanvas);
+
+    if ( ! m_graph || ! node || node->scene() != q )
+        return;
+
+    Agnode_t* n = node->d_func()->node();
+
+    if ( ! m_collapsedNodes.remove( n ) || m_unreachedNodes.contains( n ) )
+        return;
+
+    if ( m_expansionDepth > 0 )
+        collapseToDepth( QList< Agnode_t* >() << n, m_expansionDepth, true );
+
+    QList< Agnode_t* > revealed;
+    QList< Agnode_t* > queue;
+    queue.append( n );
+
+    for ( int i=0; i<queue.size(); i++ ) {
+        Agnode_t* tail = queue.at( i );
+        if ( i > 0 && m_collapsedNodes.contains( tail ) )
+            continue;
+        for (Agedge_t* edge = agfstout(m_graph, tail); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            Agnode_t* head = aghead( edge );
+            if ( m_unreachedNodes.remove( head ) ) {
+                revealed.append( head );
+                queue.append( head );
+            }
+        }
+    }
+
+    if ( showGraphItems( revealed ) && ! m_boundingBox.isNull() )
+        updateLayoutIncremental();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::isCollapsed
+ * @param node - the QGraphNode instance of the canvas
+ * @return - whether the subtree of the node is collapsed
+ */
+bool QGraphCanvasPrivate::isCollapsed(QGraphNode *node) const
+{
+    return node && m_collapsedNodes.contains( node->d_func()->node() );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::collapseCluster
+ * @param name - the name of the cluster subgraph
+ * @return - the summary node replacing the cluster (NULL if the cluster cannot be collapsed)
+ *
+ * Replaces the nodes of the cluster by a summary node labeled with the label or name of the cluster.  The summary node
+ * has one edge to and from every node outside the cluster connected to the cluster.  The summary nodes and edges are
+ * kept in a separate summary graph, where the nodes outside the clusters are represented by proxy nodes of the same
+ * name, so that the graph itself is never modified.  The summary node and its edges are placed by an incremental
+ * layout if the graph has been laid out.
+ */
+QGraphNode* QGraphCanvasPrivate::collapseCluster(const QString &name)
+{
+    Q_Q(QGraphCanvas);
+
+    if ( ! m_graph )
+        return Q_NULLPTR;
+
+    if ( m_collapsedClusters.contains( name ) )
+        return graphNode( m_collapsedClusters.value( name ) );
+
+    const QByteArray clusterName = name.toLocal8Bit();
+
+    Agraph_t* cluster = findSubgraph( m_graph, clusterName );
+
+    if ( ! cluster || 0 == agnnodes( cluster ) ) {
+        qWarning() << "WARNING: Unable to collapse unknown or empty cluster '" << name << "'";
+        return Q_NULLPTR;
+    }
+
+    Agnode_t* summary( Q_NULLPTR );
+
+    {
+        QMutexLocker locker( graphvizMutex() );
+
+        if ( ! m_summaryGraph ) {
+            m_summaryGraph = agopen( agnameof( m_graph ), m_graph->desc, NULL );
+            if ( ! m_summaryGraph )
+                return Q_NULLPTR;
+            cloneAttributeDeclarations( m_graph, m_summaryGraph );
+        }
+
+        QByteArray summaryName = clusterName + "_summary";
+        for ( int i=1; agnode( m_graph, summaryName.data(), FALSE ) || agnode( m_summaryGraph, summaryName.data(), FALSE ); i++ ) {
+            summaryName = clusterName + "_summary" + QByteArray::number( i );
+        }
+
+        summary = agnode( m_summaryGraph, summaryName.data(), TRUE );
+
+        if ( ! summary )
+            return Q_NULLPTR;
+
+        QByteArray label( agget( cluster, const_cast< char* >( "label" ) ) );
+        if ( label.isEmpty() )
+            label = clusterName;
+
+        agsafeset( summary, const_cast< char* >( "label" ), label.data(), const_cast< char* >( "\\N" ) );
+        agsafeset( summary, const_cast< char* >( "shape" ), const_cast< char* >( "box" ), const_cast< char* >( "ellipse" ) );
+        agsafeset( summary, const_cast< char* >( "style" ), const_cast< char* >( "rounded,filled" ), const_cast< char* >( "" ) );
+        agsafeset( summary, const_cast< char* >( "fillcolor" ), const_cast< char* >( "lightgrey" ), const_cast< char* >( "lightgrey" ) );
+
+        // one summary edge per connected node outside the cluster and direction
+        QSet< Agnode_t* > tails;
+        QSet< Agnode_t* > heads;
+        for (Agnode_t* node = agfstnode(cluster); node != NULL; node = agnxtnode(cluster, node)) {
+            for (Agedge_t* edge = agfstedge(m_graph, node); edge != NULL; edge = agnxtedge(m_graph, edge, node)) {
+                Agnode_t* tail = agtail( edge );
+                Agnode_t* head = aghead( edge );
+                if ( agsubnode( cluster, tail, FALSE ) && agsubnode( cluster, head, FALSE ) )
+                    continue;
+                if ( tail == node && ! heads.contains( head ) ) {
+                    heads.insert( head );
+                    agedge( m_summaryGraph, summary, agnode( m_summaryGraph, agnameof( head ), TRUE ), NULL, TRUE );
+                }
+                else if ( head == node && ! tails.contains( tail ) ) {
+                    tails.insert( tail );
+                    agedge( m_summaryGraph, agnode( m_summaryGraph, agnameof( tail ), TRUE ), summary, NULL, TRUE );
+                }
+            }
+        }
+    }
+
+    m_summaryNodes.insert( summary );
+    m_collapsedClusters.insert( name, summary );
+
+    QList< Agnode_t* > members;
+
+    for (Agnode_t* node = agfstnode(cluster); node != NULL; node = agnxtnode(cluster, node)) {
+        m_clusterNodes.insert( node );
+        members.append( node );
+    }
+
+    hideGraphItems( members );
+
+    QGraphNode* summaryNode = new QGraphNode( summary );
+    if ( addGraphNode( summaryNode ) )
+        q->addItem( summaryNode );
+    else
+        delete summaryNode;
+
+    for (Agedge_t* edge = agfstedge(m_summaryGraph, summary); edge != NULL; edge = agnxtedge(m_summaryGraph, edge, summary)) {
+        Agnode_t* proxy = ( agtail( edge ) == summary ) ? aghead( edge ) : agtail( edge );
+        if ( ! m_hiddenNodes.contains( canonicalNode( proxy ) ) )
+            showGraphEdge( edge );
+    }
+
+    if ( ! m_boundingBox.isNull() )
+        updateLayoutIncremental();
+
+    return summaryNode;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::expandCluster
+ * @param name - the name of the cluster subgraph
+ *
+ * Removes the summary node of the collapsed cluster, its edges and the proxy nodes no longer connected from the summary
+ * graph and reveals the nodes of the cluster.  The revealed nodes and edges are placed by an incremental layout if the
+ * graph has been laid out.
+ */
+void QGraphCanvasPrivate::expandCluster(const QString &name)
+{
+    if ( ! m_graph || ! m_collapsedClusters.contains( name ) )
+        return;
+
+    Agnode_t* summary = m_collapsedClusters.take( name );
+
+    // the items of the summary node and its edges are destroyed before their libcgraph objects
+    QList< QGraphicsObject* > items;
+    QList< Agnode_t* > proxies;
+
+    for (Agedge_t* edge = agfstedge(m_summaryGraph, summary); edge != NULL; edge = agnxtedge(m_summaryGraph, edge, summary)) {
+        const QString key = edgeKey( edge );
+        m_edgeItems.remove( key );
+        m_pendingEdges.removeAll( key );
+        QGraphEdge* graphEdge = QGraphCanvasPrivate::graphEdge( edge );
+        if ( graphEdge ) {
+            m_edgeItemsByNodes.remove( qMakePair( agtail( edge ), aghead( edge ) ), graphEdge );
+            items.append( graphEdge );
+        }
+        proxies.append( ( agtail( edge ) == summary ) ? aghead( edge ) : agtail( edge ) );
+    }
+
+    const QString key = QString::fromLocal8Bit( agnameof( summary ) );
+    m_nodeItems.remove( key );
+    m_pendingNodes.removeAll( key );
+    QGraphNode* graphNode = QGraphCanvasPrivate::graphNode( summary );
+    if ( graphNode )
+        items.append( graphNode );
+
+    qDeleteAll( items );
+
+    m_summaryNodes.remove( summary );
+
+    {
+        QMutexLocker locker( graphvizMutex() );
+
+        agdelnode( m_summaryGraph, summary );
+
+        foreach( Agnode_t* proxy, proxies ) {
+            if ( agfstedge( m_summaryGraph, proxy ) == NULL )
+                agdelnode( m_summaryGraph, proxy );
+        }
+    }
+
+    // nodes of nested or overlapping clusters still collapsed remain hidden
+    Agraph_t* cluster = findSubgraph( m_graph, name.toLocal8Bit() );
+
+    QSet< Agnode_t* > clusterNodes;
+
+    for ( QHash< QString, Agnode_t* >::const_iterator i = m_collapsedClusters.constBegin(); i != m_collapsedClusters.constEnd(); ++i ) {
+        Agraph_t* collapsedCluster = findSubgraph( m_graph, i.key().toLocal8Bit() );
+        if ( collapsedCluster ) {
+            for (Agnode_t* node = agfstnode(collapsedCluster); node != NULL; node = agnxtnode(collapsedCluster, node)) {
+                clusterNodes.insert( node );
+            }
+        }
+    }
+
+    m_clusterNodes = clusterNodes;
+
+    QList< Agnode_t* > revealed;
+
+    if ( cluster ) {
+        for (Agnode_t* node = agfstnode(cluster); node != NULL; node = agnxtnode(cluster, node)) {
+            if ( ! m_clusterNodes.contains( node ) && ! m_unreachedNodes.contains( node ) )
+                revealed.append( node );
+        }
+    }
+
+    if ( showGraphItems( revealed ) && ! m_boundingBox.isNull() )
+        updateLayoutIncremental();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setExpansionDepth
+ * @param depth - the number of levels shown below the roots of the graph (0 shows all levels)
+ *
+ * Sets the expansion depth and applies it to the current graph.  The nodes collapsed so far are expanded and the nodes
+ * at the depth below the roots of the graph are collapsed instead.  The whole graph is traversed once.
+ */
+void QGraphCanvasPrivate::setExpansionDepth(int depth)
+{
+    m_expansionDepth = qMax( 0, depth );
+
+    if ( ! m_graph )
+        return;
+
+    m_collapsedNodes.clear();
+
+    if ( m_expansionDepth > 0 )
+        collapseToDepth( rootNodes(), m_expansionDepth - 1, false );
+
+    const QSet< Agnode_t* > unreached = unreachedNodes();
+
+    QList< Agnode_t* > hidden;
+    foreach( Agnode_t* node, unreached ) {
+        if ( ! m_unreachedNodes.contains( node ) )
+            hidden.append( node );
+    }
+
+    QList< Agnode_t* > revealed;
+    foreach( Agnode_t* node, m_unreachedNodes ) {
+        if ( ! unreached.contains( node ) )
+            revealed.append( node );
+    }
+
+    m_unreachedNodes = unreached;
+
+    hideGraphItems( hidden );
+
+    if ( showGraphItems( revealed ) && ! m_boundingBox.isNull() )
+        updateLayoutIncremental();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::initializeVisibility
+ *
+ * Resets the collapsed nodes and clusters of a newly read graph.  When an expansion depth is set the nodes at that depth
+ * below the roots of the graph are collapsed, so that the items of the deeper nodes are not created.
+ */
+void QGraphCanvasPrivate::initializeVisibility()
+{
+    m_collapsedNodes.clear();
+    m_collapsedClusters.clear();
+    m_unreachedNodes.clear();
+    m_clusterNodes.clear();
+    m_hiddenNodes.clear();
+
+    if ( m_graph && m_expansionDepth > 0 ) {
+        collapseToDepth( rootNodes(), m_expansionDepth - 1, false );
+        m_unreachedNodes = unreachedNodes();
+        m_hiddenNodes = m_unreachedNodes;
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::collapseToDepth
+ * @param roots - the nodes at depth zero
+ * @param depth - the depth of the nodes to collapse
+ * @param unreachedOnly - whether only currently unreached nodes are traversed
+ *
+ * Traverses the out-edges of the roots breadth first and collapses the nodes at the depth having out-edges to nodes
+ * not traversed yet.  Collapsed nodes are not traversed further.
+ */
+void QGraphCanvasPrivate::collapseToDepth(const QList< Agnode_t* > &roots, int depth, bool unreachedOnly)
+{
+    QHash< Agnode_t*, int > levels;
+    QList< Agnode_t* > queue;
+
+    foreach( Agnode_t* root, roots ) {
+        if ( ! levels.contains( root ) ) {
+            levels.insert( root, 0 );
+            queue.append( root );
+        }
+    }
+
+    for ( int i=0; i<queue.size(); i++ ) {
+        Agnode_t* node = queue.at( i );
+        if ( m_collapsedNodes.contains( node ) )
+            continue;
+        const int level = levels.value( node );
+        for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            Agnode_t* head = aghead( edge );
+            if ( levels.contains( head ) || ( unreachedOnly && ! m_unreachedNodes.contains( head ) ) )
+                continue;
+            if ( level >= depth ) {
+                m_collapsedNodes.insert( node );
+                break;
+            }
+            levels.insert( head, level + 1 );
+            queue.append( head );
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::rootNodes
+ * @return - the roots of the graph
+ *
+ * Returns the nodes without in-edges followed by the first node of every cycle not reachable from these nodes, so
+ * that every node of the graph is reachable from the roots.
+ */
+QList< Agnode_t* > QGraphCanvasPrivate::rootNodes() const
+{
+    QList< Agnode_t* > roots;
+
+    if ( ! m_graph )
+        return roots;
+
+    QSet< Agnode_t* > reached;
+    QList< Agnode_t* > queue;
+
+    for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+        if ( NULL == agfstin( m_graph, node ) ) {
+            roots.append( node );
+            reached.insert( node );
+            queue.append( node );
+        }
+    }
+
+    Agnode_t* seed = agfstnode( m_graph );
+    int next( 0 );
+
+    while ( true ) {
+        while ( next < queue.size() ) {
+            Agnode_t* node = queue.at( next++ );
+            for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
+                Agnode_t* head = aghead( edge );
+                if ( ! reached.contains( head ) ) {
+                    reached.insert( head );
+                    queue.append( head );
+                }
+            }
+        }
+
+        while ( seed && reached.contains( seed ) ) {
+            seed = agnxtnode( m_graph, seed );
+        }
+
+        if ( ! seed )
+            break;
+
+        roots.append( seed );
+        reached.insert( seed );
+        queue.append( seed );
+    }
+
+    return roots;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::unreachedNodes
+ * @return - the nodes hidden by the collapsed nodes
+ *
+ * Returns the nodes not reachable from the roots of the graph without passing through a collapsed node.  The whole
+ * graph is traversed, so this is only done when a graph is read or the expansion depth changes.
+ */
+QSet< Agnode_t* > QGraphCanvasPrivate::unreachedNodes() const
+{
+    QSet< Agnode_t* > unreached;
+
+    if ( ! m_graph || m_collapsedNodes.isEmpty() )
+        return unreached;
+
+    QSet< Agnode_t* > reached;
+    QList< Agnode_t* > queue = rootNodes();
+
+    foreach( Agnode_t* root, queue ) {
+        reached.insert( root );
+    }
+
+    for ( int i=0; i<queue.size(); i++ ) {
+        Agnode_t* node = queue.at( i );
+        if ( m_collapsedNodes.contains( node ) )
+            continue;
+        for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            Agnode_t* head = aghead( edge );
+            if ( ! reached.contains( head ) ) {
+                reached.insert( head );
+                queue.append( head );
+            }
+        }
+    }
+
+    for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+        if ( ! reached.contains( node ) )
+            unreached.insert( node );
+    }
+
+    return unreached;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::hideGraphItems
+ * @param nodes - the nodes to hide
+ *
+ * Hides and deselects the items of the nodes not hidden yet, of their edges and of their summary edges.
+ */
+void QGraphCanvasPrivate::hideGraphItems(const QList< Agnode_t* > &nodes)
+{
+    foreach( Agnode_t* node, nodes ) {
+        if ( m_hiddenNodes.contains( node ) )
+            continue;
+
+        m_hiddenNodes.insert( node );
+
+        QGraphNode* graphNode = QGraphCanvasPrivate::graphNode( node );
+        if ( graphNode ) {
+            graphNode->setSelected( false );
+            graphNode->setVisible( false );
+        }
+
+        Agnode_t* proxy = ( m_summaryGraph ) ? agnode( m_summaryGraph, agnameof( node ), FALSE ) : Q_NULLPTR;
+
+        for ( int i=0; i<2; i++ ) {
+            Agraph_t* graph = ( 0 == i ) ? m_graph : m_summaryGraph;
+            Agnode_t* n = ( 0 == i ) ? node : proxy;
+            if ( ! n )
+                continue;
+            for (Agedge_t* edge = agfstedge(graph, n); edge != NULL; edge = agnxtedge(graph, edge, n)) {
+                QGraphEdge* graphEdge = QGraphCanvasPrivate::graphEdge( edge );
+                if ( graphEdge ) {
+                    graphEdge->setSelected( false );
+                    graphEdge->setVisible( false );
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::showGraphItems
+ * @param nodes - the nodes to reveal
+ * @return - whether any node was revealed
+ *
+ * Reveals the nodes which are neither unreached nor members of a collapsed cluster.  The items of the nodes, of their
+ * edges to visible nodes and of their summary edges are created or shown and become pending until they are laid out.
+ */
+bool QGraphCanvasPrivate::showGraphItems(const QList< Agnode_t* > &nodes)
+{
+    QList< Agnode_t* > revealed;
+
+    foreach( Agnode_t* node, nodes ) {
+        if ( ! m_unreachedNodes.contains( node ) && ! m_clusterNodes.contains( node ) && m_hiddenNodes.remove( node ) )
+            revealed.append( node );
+    }
+
+    foreach( Agnode_t* node, revealed ) {
+        showGraphNode( node );
+
+        for (Agedge_t* edge = agfstedge(m_graph, node); edge != NULL; edge = agnxtedge(m_graph, edge, node)) {
+            if ( ! m_hiddenNodes.contains( agtail( edge ) ) && ! m_hiddenNodes.contains( aghead( edge ) ) )
+                showGraphEdge( edge );
+        }
+
+        Agnode_t* proxy = ( m_summaryGraph ) ? agnode( m_summaryGraph, agnameof( node ), FALSE ) : Q_NULLPTR;
+
+        if ( proxy ) {
+            for (Agedge_t* edge = agfstedge(m_summaryGraph, proxy); edge != NULL; edge = agnxtedge(m_summaryGraph, edge, proxy)) {
+                showGraphEdge( edge );
+            }
+        }
+    }
+
+    return ! revealed.isEmpty();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::showGraphNode
+ * @param node - the libcgraph node instance
+ *
+ * Creates the item of the node if it has none or shows it if hidden.  The item becomes pending until it is laid out.
+ */
+void QGraphCanvasPrivate::showGraphNode(Agnode_t *node)
+{
+    Q_Q(QGraphCanvas);
+
+    QGraphNode* graphNode = QGraphCanvasPrivate::graphNode( node );
+
+    if ( ! graphNode ) {
+        graphNode = new QGraphNode( node );
+        if ( addGraphNode( graphNode ) )
+            q->addItem( graphNode );
+        else
+            delete graphNode;
+    }
+    else if ( ! graphNode->isVisible() ) {
+        graphNode->setVisible( true );
+        m_pendingNodes.append( QString::fromLocal8Bit( agnameof( node ) ) );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::showGraphEdge
+ * @param edge - the libcgraph edge instance
+ *
+ * Creates the item of the edge if it has none or shows it if hidden.  The item becomes pending until it is laid out.
+ */
+void QGraphCanvasPrivate::showGraphEdge(Agedge_t *edge)
+{
+    Q_Q(QGraphCanvas);
+
+    QGraphEdge* graphEdge = QGraphCanvasPrivate::graphEdge( edge );
+
+    if ( ! graphEdge ) {
+        graphEdge = new QGraphEdge( edge );
+        if ( addGraphEdge( graphEdge ) )
+            q->addItem( graphEdge );
+        else
+            delete graphEdge;
+    }
+    else if ( ! graphEdge->isVisible() ) {
+        graphEdge->setVisible( true );
+        m_pendingEdges.append( edgeKey( edge ) );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::canonicalNode
+ * @param node - a node of the graph or of the summary graph
+ * @return - the node of the graph represented by a proxy node of the summary graph or else the node itself
+ */
+Agnode_t* QGraphCanvasPrivate::canonicalNode(Agnode_t *node) const
+{
+    if ( m_summaryGraph && agroot( node ) == m_summaryGraph && ! m_summaryNodes.contains( node ) )
+        return agnode( m_graph, agnameof( node ), FALSE );
+
+    return node;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::findSubgraph
+ * @param graph - the libcgraph graph or subgraph instance
+ * @param name - the name of the subgraph
+ * @return - the subgraph at any nesting level (NULL if there is none)
+ */
+Agraph_t* QGraphCanvasPrivate::findSubgraph(Agraph_t *graph, const QByteArray &name)
+{
+    QByteArray subgraphName( name );
+
+    Agraph_t* subgraph = agsubg( graph, subgraphName.data(), FALSE );
+
+    for (Agraph_t* g = agfstsubg(graph); g != NULL && ! subgraph; g = agnxtsubg(g)) {
+        subgraph = findSubgraph( g, name );
+    }
+
+    return subgraph;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutSnapshot
+ * @return - a snapshot of the visible part of the graph
+ *
+ * Copies the graph without the hidden nodes and with the summary nodes of the collapsed clusters and their edges to
+ * visible nodes.  The graph is only read, so the snapshot is taken without the Graphviz library mutex and a layout
+ * running on a worker thread does not block the GUI thread.  The summary nodes are added in the order of the summary
+ * graph so that the layout of the snapshot is reproducible.  The graph is built from the snapshot by createGraph().
+ */
+QGraphCanvasPrivate::GraphSnapshot QGraphCanvasPrivate::layoutSnapshot() const
+{
+    GraphSnapshot snapshot;
+
+    if ( ! m_graph )
+        return snapshot;
+
+    snapshot.valid = true;
+    snapshot.name = agnameof( m_graph );
+    snapshot.desc = m_graph->desc;
+
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+
+    QVector< quint32 > indexes[3];
+    QHash< QByteArray, quint32 > declared[3];
+
+    for ( int i=0; i<3; i++ ) {
+        for (Agsym_t* sym = agnxtattr(m_graph, kinds[i], NULL); sym != NULL; sym = agnxtattr(m_graph, kinds[i], sym)) {
+            indexes[i].append( snapshot.declarations[i].size() );
+            declared[i].insert( QByteArray( sym->name ), snapshot.declarations[i].size() );
+            snapshot.declarations[i].append( qMakePair( QByteArray( sym->name ), QByteArray( sym->defval ) ) );
+        }
+    }
+
+    snapshotAttributes( m_graph, AGRAPH, indexes[0], true, snapshot.attributes );
+
+    QHash< Agnode_t*, int > nodeIndexes;
+    QHash< QByteArray, int > nodeNames;
+
+    nodeIndexes.reserve( agnnodes( m_graph ) );
+    snapshot.nodes.reserve( agnnodes( m_graph ) );
+    snapshot.nodeAttributes.reserve( agnnodes( m_graph ) );
+
+    for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+        if ( m_hiddenNodes.contains( node ) )
+            continue;
+        const QByteArray name( agnameof( node ) );
+        nodeIndexes.insert( node, snapshot.nodes.size() );
+        nodeNames.insert( name, snapshot.nodes.size() );
+        snapshot.nodes.append( name );
+        snapshot.nodeAttributes.append( AttributeValues() );
+        snapshotAttributes( node, AGNODE, indexes[1], false, snapshot.nodeAttributes.last() );
+    }
+
+    for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+        if ( ! nodeIndexes.contains( node ) )
+            continue;
+        for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
+            if ( ! nodeIndexes.contains( aghead( edge ) ) )
+                continue;
+            GraphSnapshot::Edge edgeSnapshot;
+            edgeSnapshot.tail = nodeIndexes.value( node );
+            edgeSnapshot.head = nodeIndexes.value( aghead( edge ) );
+            edgeSnapshot.name = agnameof( edge );
+            snapshotAttributes( edge, AGEDGE, indexes[2], false, edgeSnapshot.attributes );
+            snapshot.edges.append( edgeSnapshot );
+        }
+    }
+
+    snapshotSubgraphs( m_graph, -1, nodeIndexes, indexes[0], snapshot );
+
+    if ( m_summaryGraph && ! m_summaryNodes.isEmpty() ) {
+        // the attributes of the summary graph missing from the graph are declared with their default values
+        for ( int i=0; i<3; i++ ) {
+            indexes[i].clear();
+            for (Agsym_t* sym = agnxtattr(m_summaryGraph, kinds[i], NULL); sym != NULL; sym = agnxtattr(m_summaryGraph, kinds[i], sym)) {
+                const QByteArray name( sym->name );
+                if ( ! declared[i].contains( name ) ) {
+                    declared[i].insert( name, snapshot.declarations[i].size() );
+                    snapshot.declarations[i].append( qMakePair( name, QByteArray( sym->defval ) ) );
+                }
+                indexes[i].append( declared[i].value( name ) );
+            }
+        }
+
+        for (Agnode_t* node = agfstnode(m_summaryGraph); node != NULL; node = agnxtnode(m_summaryGraph, node)) {
+            if ( ! m_summaryNodes.contains( node ) )
+                continue;
+            const QByteArray name( agnameof( node ) );
+            nodeNames.insert( name, snapshot.nodes.size() );
+            snapshot.nodes.append( name );
+            snapshot.nodeAttributes.append( AttributeValues() );
+            snapshotAttributes( node, AGNODE, indexes[1], true, snapshot.nodeAttributes.last() );
+        }
+
+        // the proxies of the visible nodes are matched by name and the edges of the hidden ones are left out
+        for (Agnode_t* node = agfstnode(m_summaryGraph); node != NULL; node = agnxtnode(m_summaryGraph, node)) {
+            const int tail = nodeNames.value( QByteArray( agnameof( node ) ), -1 );
+            if ( tail < 0 )
+                continue;
+            for (Agedge_t* edge = agfstout(m_summaryGraph, node); edge != NULL; edge = agnxtout(m_summaryGraph, edge)) {
+                const int head = nodeNames.value( QByteArray( agnameof( aghead( edge ) ) ), -1 );
+                if ( head < 0 )
+                    continue;
+                GraphSnapshot::Edge edgeSnapshot;
+                edgeSnapshot.tail = tail;
+                edgeSnapshot.head = head;
+                edgeSnapshot.name = agnameof( edge );
+                snapshotAttributes( edge, AGEDGE, indexes[2], true, edgeSnapshot.attributes );
+                snapshot.edges.append( edgeSnapshot );
+            }
+        }
+    }
+
+    return snapshot;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::snapshotAttributes
+ * @param object - the libcgraph graph, node or edge instance
+ * @param kind - the kind of the object (AGRAPH, AGNODE or AGEDGE)
+ * @param indexes - the snapshot declaration indexes of the attributes of the root graph of the object
+ * @param all - whether the values equal to the default values are copied as well
+ * @param values - the attribute values receiving the values of the object
+ *
+ * Copies the attribute values of the object as written by writeSnapshotAttributes().
+ */
+void QGraphCanvasPrivate::snapshotAttributes(void *object, int kind, const QVector< quint32 > &indexes, bool all, AttributeValues &values)
+{
+    Agraph_t* root = agroot( object );
+
+    int index( 0 );
+    for (Agsym_t* sym = agnxtattr(root, kind, NULL); sym != NULL && index < indexes.size(); sym = agnxtattr(root, kind, sym), index++) {
+        const char* value = agxget( object, sym );
+        if ( all || qstrcmp( value, sym->defval ) != 0 )
+            values << qMakePair( indexes[ index ], QByteArray( value ) );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::snapshotSubgraphs
+ * @param graph - the libcgraph graph or subgraph instance
+ * @param parent - the snapshot index of the graph (-1 for the root graph)
+ * @param nodeIndexes - the snapshot indexes of the visible nodes
+ * @param indexes - the snapshot declaration indexes of the graph attributes
+ * @param snapshot - the graph snapshot receiving the subgraphs
+ *
+ * Recursively copies the subgraphs (including clusters) and their attributes and node membership.  Hidden nodes are
+ * skipped and subgraphs left without nodes are omitted along with their nested subgraphs.
+ */
+void QGraphCanvasPrivate::snapshotSubgraphs(Agraph_t *graph, int parent, const QHash< Agnode_t*, int > &nodeIndexes, const QVector< quint32 > &indexes, GraphSnapshot &snapshot)
+{
+    for (Agraph_t* subgraph = agfstsubg(graph); subgraph != NULL; subgraph = agnxtsubg(subgraph)) {
+        GraphSnapshot::Subgraph subgraphSnapshot;
+        subgraphSnapshot.parent = parent;
+        subgraphSnapshot.name = agnameof( subgraph );
+        snapshotAttributes( subgraph, AGRAPH, indexes, true, subgraphSnapshot.attributes );
+
+        for (Agnode_t* node = agfstnode(subgraph); node != NULL; node = agnxtnode(subgraph, node)) {
+            const int index = nodeIndexes.value( node, -1 );
+            if ( index >= 0 )
+                subgraphSnapshot.nodes.append( index );
+        }
+
+        if ( subgraphSnapshot.nodes.isEmpty() && agnnodes( subgraph ) > 0 )
+            continue;
+
+        const int index = snapshot.subgraphs.size();
+        snapshot.subgraphs.append( subgraphSnapshot );
+
+        snapshotSubgraphs( subgraph, index, nodeIndexes, indexes, snapshot );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::createGraph
+ * @param snapshot - the graph snapshot
+ * @return - the libcgraph graph instance built from the snapshot (NULL on failure)
+ *
+ * Creates the graph copied by layoutSnapshot().  The caller owns the returned graph and must hold the Graphviz
+ * library mutex.
+ */
+Agraph_t* QGraphCanvasPrivate::createGraph(const GraphSnapshot &snapshot)
+{
+    if ( ! snapshot.valid )
+        return Q_NULLPTR;
+
+    QByteArray name( snapshot.name );
+
+    Agraph_t* graph = agopen( name.data(), snapshot.desc, NULL );
+
+    if ( ! graph )
+        return graph;
+
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+
+    QVector< Agsym_t* > symbols[3];
+
+    for ( int i=0; i<3; i++ ) {
+        for ( int j=0; j<snapshot.declarations[i].size(); j++ ) {
+            QByteArray attributeName( snapshot.declarations[i][j].first );
+            QByteArray defaultValue( snapshot.declarations[i][j].second );
+            symbols[i].append( agattr( graph, kinds[i], attributeName.data(), defaultValue.data() ) );
+        }
+    }
+
+    for ( int i=0; i<snapshot.attributes.size(); i++ ) {
+        setAttributeValue( graph, symbols[0].value( snapshot.attributes[i].first ), snapshot.attributes[i].second );
+    }
+
+    QVector< Agnode_t* > nodes( snapshot.nodes.size() );
+
+    for ( int i=0; i<snapshot.nodes.size(); i++ ) {
+        QByteArray nodeName( snapshot.nodes[i] );
+        nodes[i] = agnode( graph, nodeName.data(), TRUE );
+        const AttributeValues& values = snapshot.nodeAttributes[i];
+        for ( int j=0; j<values.size(); j++ ) {
+            setAttributeValue( nodes[i], symbols[1].value( values[j].first ), values[j].second );
+        }
+    }
+
+    foreach ( const GraphSnapshot::Edge& edgeSnapshot, snapshot.edges ) {
+        Agnode_t* tail = nodes[ edgeSnapshot.tail ];
+        Agnode_t* head = nodes[ edgeSnapshot.head ];
+        if ( ! tail || ! head )
+            continue;
+        QByteArray edgeName( edgeSnapshot.name );
+        Agedge_t* edge = agedge( graph, tail, head, edgeName.isNull() ? NULL : edgeName.data(), TRUE );
+        for ( int j=0; edge && j<edgeSnapshot.attributes.size(); j++ ) {
+            setAttributeValue( edge, symbols[2].value( edgeSnapshot.attributes[j].first ), edgeSnapshot.attributes[j].second );
+        }
+    }
+
+    QVector< Agraph_t* > subgraphs( snapshot.subgraphs.size() );
+
+    for ( int i=0; i<snapshot.subgraphs.size(); i++ ) {
+        const GraphSnapshot::Subgraph& subgraphSnapshot = snapshot.subgraphs[i];
+        QByteArray subgraphName( subgraphSnapshot.name );
+        Agraph_t* parent = ( subgraphSnapshot.parent < 0 ) ? graph : subgraphs[ subgraphSnapshot.parent ];
+        subgraphs[i] = parent ? agsubg( parent, subgraphName.data(), TRUE ) : Q_NULLPTR;
+        if ( ! subgraphs[i] )
+            continue;
+        for ( int j=0; j<subgraphSnapshot.attributes.size(); j++ ) {
+            setAttributeValue( subgraphs[i], symbols[0].value( subgraphSnapshot.attributes[j].first ), subgraphSnapshot.attributes[j].second );
+        }
+        foreach ( int node, subgraphSnapshot.nodes ) {
+            if ( nodes[ node ] )
+                agsubnode( subgraphs[i], nodes[ node ], TRUE );
+        }
+    }
+
+    return graph;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::declareMissingAttributes
+ * @param graph - the libcgraph graph instance
+ * @param clone - the libcgraph graph instance receiving the attribute declarations
+ *
+ * Declares the graph, node and edge attributes of the graph not declared in the clone yet with their default values.
+ * The default values of the attributes already declared in the clone are kept.
+ */
+void QGraphCanvasPrivate::declareMissingAttributes(Agraph_t *graph, Agraph_t *clone)
+{
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+    for ( int i=0; i<3; i++ ) {
+        for (Agsym_t* sym = agnxtattr(graph, kinds[i], NULL); sym != NULL; sym = agnxtattr(graph, kinds[i], sym)) {
+            if ( ! agattr( clone, kinds[i], sym->name, NULL ) )
+                agattr( clone, kinds[i], sym->name, sym->defval );
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::updateLayout
+ *
+ * Updates the layout of the graph canvas.
+ */
+void QGraphCanvasPrivate::updateLayout()
+{
+    if ( m_gvc && m_graph ) {
+        // supersede any pending asynchronous layout
+        nextGeneration();
+
+        // the nodes hidden by collapsed subtrees and clusters are left out of a snapshot of the graph and the summary
+        // nodes of the collapsed clusters are added to it
+        if ( ! m_hiddenNodes.isEmpty() || ! m_summaryNodes.isEmpty() ) {
+            LayoutRequest request;
+            request.gvc = m_gvc;
+            request.generation = m_generation;
+            request.latestGeneration = m_latestGeneration;
+            request.logicalDpiY = logicalDpiY();
+            request.cacheDirectory = m_layoutCacheDirectory;
+            request.engine = layoutEngineName();
+
+            request.snapshot = layoutSnapshot();
+
+            // computeLayout() takes the Graphviz library mutex itself to build and lay out the snapshot
+            if ( request.snapshot.valid ) {
+                const LayoutResult result = computeLayout( request );
+                if ( result.valid )
+                    applyLayout( result );
+            }
+
+            return;
+        }
+
+        LayoutGeometry geometry;
+
+        {
+            QMutexLocker locker( graphvizMutex() );
+
+            const int logicalDpiY = QGraphCanvasPrivate::logicalDpiY();
+            const QByteArray engine = layoutEngineName();
+            const QString cacheFileName = layoutCacheFileName( m_layoutCacheDirectory, m_gvc, m_graph, engine );
+
+            geometry = cachedLayout( m_gvc, m_graph, cacheFileName, logicalDpiY );
+
+            if ( ! geometry.valid ) {
+                // free the previous layout instead of stacking a new layout on top of it
+                freeLayout();
+                m_graphLaidOut = true;
+
+                if ( 0 == gvLayout( m_gvc, m_graph, engine.constData() ) ) {
+                    geometry = layoutGeometry( m_graph, logicalDpiY );
+                    writeLayoutCache( cacheFileName, m_graph );
+                }
+                else {
+                    qCritical() << "ERROR: Unable to layout graph using the '" << engine << "' layout engine";
+                }
+            }
+        }
+
+        if ( geometry.valid ) {
+            applyLayout( layoutResult( geometry ) );
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::updateLayoutAsync
+ *
+ * Updates the layout of the graph canvas on a worker thread.  The layout is computed against a snapshot
+ * of the graph so that the graph may continue to be modified on the GUI thread.  When the layout completes
+ * the resulting node and edge states are applied in one batch on the GUI thread and the layoutUpdated() signal
+ * is emitted.  The snapshot is taken without the Graphviz library mutex so that the request never waits for a layout
+ * running on a worker thread.  A layout still waiting for the Graphviz library when a newer layout is requested is
+ * skipped.  A layout already inside the Graphviz library cannot be interrupted, so it runs to completion and its
+ * result is discarded.
+ */
+void QGraphCanvasPrivate::updateLayoutAsync()
+{
+    if ( m_gvc && m_graph ) {
+        LayoutRequest request;
+        request.gvc = m_gvc;
+        request.generation = nextGeneration();
+        request.latestGeneration = m_latestGeneration;
+        request.logicalDpiY = logicalDpiY();
+        request.cacheDirectory = m_layoutCacheDirectory;
+        request.engine = layoutEngineName();
+
+        // the snapshot is taken without the Graphviz library mutex which a previous layout worker may hold
+        request.snapshot = layoutSnapshot();
+
+        if ( request.snapshot.valid ) {
+            m_layoutWatcher->setFuture( QtConcurrent::run( &QGraphCanvasPrivate::computeLayout, request ) );
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::updateLayoutIncremental
+ *
+ * Lays out only the nodes and edges added since the last layout while preserving the positions of all other nodes.
+ * A local graph is built from the new nodes and edges, the already laid out nodes they are connected to and the
+ * already laid out nodes in their vicinity.  The already laid out nodes are pinned at their current positions and
+ * the new nodes are placed near their laid out neighbors before the local graph is laid out by the "neato" engine.
+ * Only the states of the new nodes and edges are updated.  A full layout is done if the graph has not been laid out yet.
+ */
+void QGraphCanvasPrivate::updateLayoutIncremental()
+{
+    if ( ! m_gvc || ! m_graph )
+        return;
+
+    if ( m_boundingBox.isNull() ) {
+        updateLayout();
+        return;
+    }
+
+    if ( m_pendingNodes.isEmpty() && m_pendingEdges.isEmpty() )
+        return;
+
+    Q_Q(QGraphCanvas);
+
+    // distance in points between the new nodes and their neighbors and the margin of the vicinity of the new nodes
+    const qreal SPACING = 72.0;
+
+    // pending items deleted before being laid out are dropped, hidden items remain pending until revealed and items
+    // revealed more than once are laid out once
+    QList< QGraphNode* > pendingNodes;
+    QSet< Agnode_t* > pending;
+    foreach( const QString& key, m_pendingNodes ) {
+        QGraphNode* node = m_nodeItems.value( key );
+        if ( ! node ) {
+            m_pendingNodes.removeOne( key );
+        }
+        else if ( node->isVisible() && ! pending.contains( node->d_func()->node() ) ) {
+            pendingNodes.append( node );
+            pending.insert( node->d_func()->node() );
+        }
+    }
+
+    QList< QGraphEdge* > pendingEdges;
+    QSet< QGraphEdge* > pendingEdgeSet;
+    foreach( const QString& key, m_pendingEdges ) {
+        QGraphEdge* edge = m_edgeItems.value( key );
+        if ( ! edge ) {
+            m_pendingEdges.removeOne( key );
+        }
+        else if ( edge->isVisible() && ! pendingEdgeSet.contains( edge ) ) {
+            pendingEdges.append( edge );
+            pendingEdgeSet.insert( edge );
+        }
+    }
+
+    if ( pendingNodes.isEmpty() && pendingEdges.isEmpty() )
+        return;
+
+    // positions of the local graph nodes in the Graphviz coordinate system and whether they are pinned
+    QList< Agnode_t* > nodes;
+    QHash< Agnode_t*, QPointF > positions;
+    QSet< Agnode_t* > pinned;
+
+    // the laid out endpoints of the new edges are pinned; summary edges refer to proxies of the graph nodes
+    foreach( QGraphEdge* edge, pendingEdges ) {
+        Agedge_t* e = edge->d_func()->m_edge;
+        Agnode_t* endpoints[] = { canonicalNode( agtail( e ) ), canonicalNode( aghead( e ) ) };
+        for ( int i=0; i<2; i++ ) {
+            if ( ! endpoints[i] )
+                continue;
+            QGraphNode* node = graphNode( endpoints[i] );
+            if ( node && ! pending.contains( endpoints[i] ) && ! positions.contains( endpoints[i] ) ) {
+                nodes.append( endpoints[i] );
+                positions.insert( endpoints[i], QPointF( node->pos().x(), m_layoutMirrorY - node->pos().y() ) );
+                pinned.insert( endpoints[i] );
+            }
+        }
+    }
+
+    // the new nodes are placed below the centroid of their neighbors with known positions and spread out horizontally
+    QHash< QPair< int, int >, int > siblings;
+    int unconnected( 0 );
+    foreach( QGraphNode* node, pendingNodes ) {
+        Agnode_t* n = node->d_func()->node();
+        Agraph_t* root = agroot( n );
+        QPointF centroid;
+        int count( 0 );
+        for (Agedge_t* e = agfstedge(root, n); e != NULL; e = agnxtedge(root, e, n)) {
+            Agnode_t* neighbor = canonicalNode( ( agtail( e ) == n ) ? aghead( e ) : agtail( e ) );
+            if ( positions.contains( neighbor ) ) {
+                centroid += positions.value( neighbor );
+                count++;
+            }
+        }
+        QPointF position;
+        if ( count > 0 ) {
+            centroid /= count;
+            const QPair< int, int > key( qRound( centroid.x() ), qRound( centroid.y() ) );
+            const int index = siblings.value( key, 0 );
+            siblings.insert( key, index + 1 );
+            const qreal offset = ( ( index + 1 ) / 2 ) * SPACING * ( ( index % 2 ) ? 1.0 : -1.0 );
+            position = QPointF( centroid.x() + offset, centroid.y() - SPACING );
+        }
+        else {
+            // unconnected nodes are lined up below the bounding box which is given in the Qt coordinate system
+            const QPointF scenePosition( m_boundingBox.left() + SPACING * unconnected++, m_boundingBox.bottom() + SPACING );
+            position = QPointF( scenePosition.x(), m_layoutMirrorY - scenePosition.y() );
+        }
+        nodes.append( n );
+        positions.insert( n, position );
+    }
+
+    // the laid out nodes in the vicinity of the new nodes are pinned so that the new nodes are placed around them
+    QRectF vicinity;
+    foreach( const QPointF& position, positions ) {
+        vicinity |= QRectF( position, QSizeF( 1.0, 1.0 ) );
+    }
+    vicinity.adjust( -SPACING, -SPACING, SPACING, SPACING );
+    const QRectF sceneVicinity( vicinity.left(), m_layoutMirrorY - vicinity.bottom(), vicinity.width(), vicinity.height() );
+    foreach( QGraphicsItem* item, q->items( sceneVicinity, Qt::IntersectsItemBoundingRect ) ) {
+        if ( item->type() == QGraphNode::Type && item->isVisible() ) {
+            QGraphNode* node = qgraphicsitem_cast< QGraphNode* >( item );
+            Agnode_t* n = node->d_func()->node();
+            if ( ! pending.contains( n ) && ! positions.contains( n ) ) {
+                nodes.append( n );
+                positions.insert( n, QPointF( node->pos().x(), m_layoutMirrorY - node->pos().y() ) );
+                pinned.insert( n );
+            }
+        }
+    }
+
+    QList< QPair< QGraphNode*, QGraphNodePrivate::Geometry > > nodeGeometries;
+    QList< QPair< QGraphEdge*, QGraphEdgePrivate::Geometry > > edgeGeometries;
+
+    {
+        QMutexLocker locker( graphvizMutex() );
+
+        Agraph_t* local = agopen( agnameof( m_graph ), m_graph->desc, NULL );
+
+        if ( ! local )
+            return;
+
+        cloneAttributeDeclarations( m_graph, local );
+        if ( m_summaryGraph )
+            declareMissingAttributes( m_summaryGraph, local );
+
+        // keep the input coordinate system, avoid node overlaps and route the edges around the nodes
+        agattr( local, AGRAPH, const_cast< char* >( "notranslate" ), const_cast< char* >( "true" ) );
+        agattr( local, AGRAPH, const_cast< char* >( "overlap" ), const_cast< char* >( "false" ) );
+        agattr( local, AGRAPH, const_cast< char* >( "splines" ), const_cast< char* >( "true" ) );
+        agattr( local, AGNODE, const_cast< char* >( "pos" ), const_cast< char* >( "" ) );
+
+        QHash< Agnode_t*, Agnode_t* > localNodes;
+
+        foreach( Agnode_t* n, nodes ) {
+            Agnode_t* localNode = agnode( local, agnameof( n ), TRUE );
+            agcopyattr( n, localNode );
+            // positions are specified in inches and the trailing '!' pins the node
+            const QPointF position = positions.value( n );
+            QString pos = QStringLiteral("%1,%2").arg( position.x() / 72.0, 0, 'g', 17 ).arg( position.y() / 72.0, 0, 'g', 17 );
+            if ( pinned.contains( n ) )
+                pos += QStringLiteral("!");
+            agxset( localNode, agattr( local, AGNODE, const_cast< char* >( "pos" ), NULL ), pos.toLocal8Bit().data() );
+            localNodes.insert( n, localNode );
+        }
+
+        QList< QPair< QGraphEdge*, Agedge_t* > > localEdges;
+
+        foreach( QGraphEdge* edge, pendingEdges ) {
+            Agedge_t* e = edge->d_func()->m_edge;
+            Agnode_t* tail = localNodes.value( canonicalNode( agtail( e ) ) );
+            Agnode_t* head = localNodes.value( canonicalNode( aghead( e ) ) );
+            if ( tail && head ) {
+                Agedge_t* localEdge = agedge( local, tail, head, agnameof( e ), TRUE );
+                agcopyattr( e, localEdge );
+                localEdges.append( qMakePair( edge, localEdge ) );
+            }
+        }
+
+        if ( 0 == gvLayout( m_gvc, local, "neato" ) ) {
+            // the local graph is not translated so it is converted to the Qt coordinate system of the last full layout
+            // by the same mirror transform as the pinned node positions
+            const int logicalDpiY = QGraphCanvasPrivate::logicalDpiY();
+
+            foreach( QGraphNode* node, pendingNodes ) {
+                nodeGeometries.append( qMakePair( node, QGraphNodePrivate::layoutGeometry( localNodes.value( node->d_func()->node() ), logicalDpiY, m_layoutMirrorY ) ) );
+            }
+
+            for ( int i=0; i<localEdges.size(); i++ ) {
+                edgeGeometries.append( qMakePair( localEdges[i].first, QGraphEdgePrivate::layoutGeometry( localEdges[i].second, logicalDpiY, m_layoutMirrorY ) ) );
+            }
+        }
+
+        gvFreeLayout( m_gvc, local );
+        agclose( local );
+    }
+
+    if ( nodeGeometries.isEmpty() && edgeGeometries.isEmpty() )
+        return;
+
+    QSet< QString > laidOutNodes;
+    for ( int i=0; i<nodeGeometries.size(); i++ ) {
+        QGraphNode* node = nodeGeometries[i].first;
+        node->prepareGeometryChange();
+        node->d_func()->setState( QGraphNodePrivate::layoutState( nodeGeometries[i].second ) );
+        m_boundingBox |= node->sceneBoundingRect();
+        laidOutNodes.insert( QString::fromLocal8Bit( agnameof( node->d_func()->node() ) ) );
+    }
+
+    QSet< QString > laidOutEdges;
+    for ( int i=0; i<edgeGeometries.size(); i++ ) {
+        QGraphEdge* edge = edgeGeometries[i].first;
+        edge->prepareGeometryChange();
+        edge->d_func()->setState( QGraphEdgePrivate::layoutState( edgeGeometries[i].second ) );
+        m_boundingBox |= edge->sceneBoundingRect();
+        laidOutEdges.insert( edgeKey( edge->d_func()->m_edge ) );
+    }
+
+    // remove the laid out items and their duplicates from the pending items in one pass
+    QList< QString > stillPendingNodes;
+    foreach( const QString& key, m_pendingNodes ) {
+        if ( ! laidOutNodes.contains( key ) )
+            stillPendingNodes.append( key );
+    }
+    m_pendingNodes = stillPendingNodes;
+
+    QList< QString > stillPendingEdges;
+    foreach( const QString& key, m_pendingEdges ) {
+        if ( ! laidOutEdges.contains( key ) )
+            stillPendingEdges.append( key );
+    }
+    m_pendingEdges = stillPendingEdges;
+
+    invalidateItemIndex();
+
+    emit q->layoutUpdated();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::handleLayoutFinished
+ *
+ * Applies the result of the asynchronous layout unless it has been superseded by a newer layout request.
+ */
+void QGraphCanvasPrivate::handleLayoutFinished()
+{
+    const LayoutResult result = m_layoutWatcher->result();
+
+    if ( result.valid && result.generation == m_generation ) {
+        applyLayout( result );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::nextGeneration
+ * @return - the generation number assigned to the new layout request
+ *
+ * Assigns a new generation number to a layout request which supersedes all previous layout requests.
+ */
+int QGraphCanvasPrivate::nextGeneration()
+{
+    m_generation = m_latestGeneration->fetchAndAddOrdered( 1 ) + 1;
+
+    return m_generation;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::computeLayout
+ * @param request - the layout request
+ * @return - the node and edge states after layout
+ *
+ * Worker thread function computing the layout of the graph snapshot contained in the layout request.  The graph is
+ * built from the snapshot once the Graphviz library mutex is held and closed before returning.
+ */
+QGraphCanvasPrivate::LayoutResult QGraphCanvasPrivate::computeLayout(const LayoutRequest &request)
+{
+    LayoutGeometry geometry;
+
+    {
+        QMutexLocker locker( graphvizMutex() );
+
+        // skip the layout if superseded by a newer layout request while waiting for the Graphviz library
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+        const int latestGeneration = request.latestGeneration->load();
+#else
+        const int latestGeneration = *request.latestGeneration;
+#endif
+        // the graph of a superseded request is not even built
+        Agraph_t* graph = ( request.generation == latestGeneration ) ? createGraph( request.snapshot ) : Q_NULLPTR;
+
+        if ( graph ) {
+            const QString cacheFileName = layoutCacheFileName( request.cacheDirectory, request.gvc, graph, request.engine );
+
+            geometry = cachedLayout( request.gvc, graph, cacheFileName, request.logicalDpiY );
+
+            if ( ! geometry.valid ) {
+                if ( 0 == gvLayout( request.gvc, graph, request.engine.constData() ) ) {
+                    geometry = layoutGeometry( graph, request.logicalDpiY );
+                    writeLayoutCache( cacheFileName, graph );
+                }
+                else {
+                    qCritical() << "ERROR: Unable to layout graph using the '" << request.engine << "' layout engine";
+                }
+            }
+
+            gvFreeLayout( request.gvc, graph );
+            agclose( graph );
+        }
+    }
+
+    // the painter paths are built after releasing the Graphviz library mutex
+    LayoutResult result = layoutResult( geometry );
+
+    result.generation = request.generation;
+
+    return result;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::cachedLayout
+ * @param gvc - the Graphviz context
+ * @param graph - the libcgraph graph instance
+ * @param cacheFileName - the layout cache file of the graph (empty if the layout cache is disabled)
+ * @param logicalDpiY - the logical DPI Y used to scale the edge label fonts
+ * @return - the node and edge geometries after layout (invalid if the layout is not cached)
+ *
+ * Restores the layout of the graph from the layout cache.  The cached positions, spline control points and
+ * label positions are set on a snapshot of the graph which is laid out by the "nop2" engine.  This engine
+ * adopts the given node positions and edge splines as is, so that the layout engine is skipped entirely.
+ * The caller must hold the Graphviz library mutex.
+ */
+QGraphCanvasPrivate::LayoutGeometry QGraphCanvasPrivate::cachedLayout(GVC_t *gvc, Agraph_t *graph, const QString &cacheFileName, int logicalDpiY)
+{
+    LayoutGeometry result;
+
+    LayoutAttributes attributes;
+
+    if ( ! cacheFileName.isEmpty() && readLayoutCache( cacheFileName, attributes ) ) {
+        Agraph_t* clone = cloneGraph( graph );
+
+        if ( clone ) {
+            setLayoutAttributes( clone, attributes );
+
+            if ( 0 == gvLayout( gvc, clone, "nop2" ) ) {
+                result = layoutGeometry( clone, logicalDpiY );
+            }
+            else {
+                qWarning() << "WARNING: Unable to restore cached layout from '" << cacheFileName << "'";
+            }
+
+            gvFreeLayout( gvc, clone );
+            agclose( clone );
+        }
+    }
+
+    return result;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutGeometry
+ * @param graph - the libcgraph graph instance that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the node and edge label fonts
+ * @return - the node and edge geometries after layout
+ *
+ * Copies the geometries of all nodes and edges of the graph after layout.  The caller must hold the Graphviz library mutex.
+ */
+QGraphCanvasPrivate::LayoutGeometry QGraphCanvasPrivate::layoutGeometry(Agraph_t *graph, int logicalDpiY)
+{
+    LayoutGeometry geometry;
+
+    geometry.valid = true;
+    geometry.boundingBox = layoutBoundingBox( graph );
+
+    geometry.nodeKeys.reserve( agnnodes( graph ) );
+    geometry.nodes.reserve( agnnodes( graph ) );
+    geometry.edgeKeys.reserve( agnedges( graph ) );
+    geometry.edges.reserve( agnedges( graph ) );
+
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        geometry.nodeKeys.append( QString::fromLocal8Bit( agnameof( node ) ) );
+        geometry.nodes.append( QGraphNodePrivate::layoutGeometry( node, logicalDpiY ) );
+        geometry.edgeKeys += edgeKeys( graph, node );
+        for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge)) {
+            geometry.edges.append( QGraphEdgePrivate::layoutGeometry( edge, logicalDpiY ) );
+        }
+    }
+
+    return geometry;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutResult
+ * @param geometry - the node and edge geometries after layout
+ * @return - the node and edge states after layout
+ *
+ * Computes the states of all nodes and edges from their geometries.  The painter paths are built concurrently
+ * by the global thread pool since this does not access the libcgraph graph.  Identical edge label texts are shared.
+ */
+QGraphCanvasPrivate::LayoutResult QGraphCanvasPrivate::layoutResult(const LayoutGeometry &geometry)
+{
+    LayoutResult result;
+
+    result.valid = geometry.valid;
+    result.boundingBox = geometry.boundingBox;
+
+    // select the overloads computing the states from the geometries
+    QGraphNodePrivate::State (*nodeState)(const QGraphNodePrivate::Geometry&) = &QGraphNodePrivate::layoutState;
+    QGraphEdgePrivate::State (*edgeState)(const QGraphEdgePrivate::Geometry&) = &QGraphEdgePrivate::layoutState;
+
+    const QVector< QGraphNodePrivate::State > nodeStates =
+            QtConcurrent::blockingMapped< QVector< QGraphNodePrivate::State > >( geometry.nodes, nodeState );
+    const QVector< QGraphEdgePrivate::State > edgeStates =
+            QtConcurrent::blockingMapped< QVector< QGraphEdgePrivate::State > >( geometry.edges, edgeState );
+
+    result.nodes.reserve( nodeStates.size() );
+    for ( int i=0; i<nodeStates.size(); i++ ) {
+        result.nodes.insert( geometry.nodeKeys[i], nodeStates[i] );
+    }
+
+    // edges with the same label text and font share a single QStaticText instance so that the text is laid out once
+    QHash< QString, QStaticText > labelTexts;
+
+    result.edges.reserve( edgeStates.size() );
+    for ( int i=0; i<edgeStates.size(); i++ ) {
+        QGraphEdgePrivate::State state = edgeStates[i];
+        if ( ! state.labelText.text().isEmpty() ) {
+            const QString key = state.font.key() + QLatin1Char('\n') + state.labelText.text();
+            QHash< QString, QStaticText >::const_iterator iter = labelTexts.constFind( key );
+            if ( iter != labelTexts.constEnd() )
+                state.labelText = *iter;
+            else
+                labelTexts.insert( key, state.labelText );
+        }
+        result.edges.insert( geometry.edgeKeys[i], state );
+    }
+
+    return result;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::applyLayout
+ * @param result - the node and edge states after layout
+ *
+ * Applies the node and edge states to the QGraphNode and QGraphEdge instances of the canvas in one pass
+ * and then emits the layoutUpdated() signal.  The scene index is disabled while the geometry of the items
+ * changes, so that it is rebuilt once instead of being updated for every item.
+ */
+void QGraphCanvasPrivate::applyLayout(const LayoutResult &result)
+{
+    Q_Q(QGraphCanvas);
+
+    m_boundingBox = result.boundingBox;
+    m_layoutMirrorY = result.boundingBox.top() + result.boundingBox.bottom();
+
+    // disable the scene index while the geometry of the items changes and rebuild it once afterwards
+    const QGraphicsScene::ItemIndexMethod indexMethod = q->itemIndexMethod();
+    q->setItemIndexMethod( QGraphicsScene::NoIndex );
+
+    QHash< QString, QPointer< QGraphNode > >::iterator nodeIter = m_nodeItems.begin();
+    while ( nodeIter != m_nodeItems.end() ) {
+        QGraphNode* node = nodeIter.value();
+        if ( ! node ) {
+            nodeIter = m_nodeItems.erase( nodeIter );
+            continue;
+        }
+        QHash< QString, QGraphNodePrivate::State >::const_iterator stateIter = result.nodes.constFind( nodeIter.key() );
+        if ( stateIter != result.nodes.constEnd() && node->scene() == q ) {
+            node->prepareGeometryChange();
+            node->d_func()->setState( *stateIter );
+        }
+        ++nodeIter;
+    }
+
+    QHash< QString, QPointer< QGraphEdge > >::iterator edgeIter = m_edgeItems.begin();
+    while ( edgeIter != m_edgeItems.end() ) {
+        QGraphEdge* edge = edgeIter.value();
+        if ( ! edge ) {
+            edgeIter = m_edgeItems.erase( edgeIter );
+            continue;
+        }
+        QHash< QString, QGraphEdgePrivate::State >::const_iterator stateIter = result.edges.constFind( edgeIter.key() );
+        if ( stateIter != result.edges.constEnd() && edge->scene() == q ) {
+            edge->prepareGeometryChange();
+            edge->d_func()->setState( *stateIter );
+        }
+        ++edgeIter;
+    }
+
+    // choose the BSP tree depth from the number of items before the scene index is rebuilt
+    if ( m_staticItemIndex && indexMethod == QGraphicsScene::BspTreeIndex )
+        q->setBspTreeDepth( bspTreeDepth( m_nodeItems.size() + m_edgeItems.size() ) );
+
+    q->setItemIndexMethod( indexMethod );
+
+    // the item geometries are static until the next layout
+    invalidateItemIndex();
+    if ( m_staticItemIndex )
+        buildItemIndex();
+
+    // items added after the snapshot of an asynchronous layout was taken remain pending
+    QList< QString > pendingNodes;
+    foreach( const QString& key, m_pendingNodes ) {
+        if ( ! result.nodes.contains( key ) && m_nodeItems.contains( key ) )
+            pendingNodes.append( key );
+    }
+    m_pendingNodes = pendingNodes;
+
+    QList< QString > pendingEdges;
+    foreach( const QString& key, m_pendingEdges ) {
+        if ( ! result.edges.contains( key ) && m_edgeItems.contains( key ) )
+            pendingEdges.append( key );
+    }
+    m_pendingEdges = pendingEdges;
+
+    emit q->layoutUpdated();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::edgeKey
+ * @param edge - the libcgraph edge instance
+ * @return - the key identifying the edge
+ *
+ * Returns a key identifying the edge which is the same for the corresponding edge of a snapshot of the graph.
+ * Named edges are identified by the tail and head node names and the edge name.  Anonymous edges are additionally
+ * identified by their position among the parallel edges in the out-edge list of the tail node.  The position is
+ * counted over the shorter of the out-edge list of the tail node and the in-edge list of the head node; use
+ * edgeKeys() for the keys of all out-edges of a node.
+ */
+QString QGraphCanvasPrivate::edgeKey(Agedge_t *edge)
+{
+    const char* name = agnameof( edge );
+
+    if ( name && *name )
+        return edgeKey( edge, 0 );
+
+    Agraph_t* graph = agraphof( edge );
+    Agnode_t* tail = agtail( edge );
+    Agnode_t* head = aghead( edge );
+
+    // the edge lists are ordered by sequence number which is shared by both halves of an edge
+    int ordinal( 0 );
+    if ( agdegree( graph, head, TRUE, FALSE ) < agdegree( graph, tail, FALSE, TRUE ) ) {
+        for (Agedge_t* e = agfstin(graph, head); e != NULL; e = agnxtin(graph, e)) {
+            if ( agtail( e ) == tail && AGSEQ( e ) < AGSEQ( edge ) )
+                ordinal++;
+        }
+    }
+    else {
+        for (Agedge_t* e = agfstout(graph, tail); e != NULL && AGSEQ( e ) < AGSEQ( edge ); e = agnxtout(graph, e)) {
+            if ( aghead( e ) == head )
+                ordinal++;
+        }
+    }
+
+    return edgeKey( edge, ordinal );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::edgeKey
+ * @param edge - the libcgraph edge instance
+ * @param ordinal - the position of the edge among the parallel edges in the out-edge list of the tail node
+ * @return - the key identifying the edge
+ *
+ * Formats the key identifying the edge.  The ordinal is only used for anonymous edges.
+ */
+QString QGraphCanvasPrivate::edgeKey(Agedge_t *edge, int ordinal)
+{
+    QString key = QString::fromLocal8Bit( agnameof( agtail( edge ) ) );
+    key += QStringLiteral("->");
+    key += QString::fromLocal8Bit( agnameof( aghead( edge ) ) );
+
+    const char* name = agnameof( edge );
+
+    if ( name && *name ) {
+        key += QStringLiteral(":");
+        key += QString::fromLocal8Bit( name );
+    }
+    else {
+        key += QStringLiteral("#");
+        key += QString::number( ordinal );
+    }
+
+    return key;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::edgeKeys
+ * @param graph - the libcgraph graph instance
+ * @param tail - the libcgraph tail node instance
+ * @return - the keys of the out-edges of the tail node in the order of its out-edge list
+ *
+ * Returns the same keys as edgeKey() for all out-edges of the tail node in one pass over its out-edge list.
+ */
+QVector< QString > QGraphCanvasPrivate::edgeKeys(Agraph_t *graph, Agnode_t *tail)
+{
+    QVector< QString > keys;
+    keys.reserve( agdegree( graph, tail, FALSE, TRUE ) );
+
+    QHash< Agnode_t*, int > ordinals;
+    for (Agedge_t* edge = agfstout(graph, tail); edge != NULL; edge = agnxtout(graph, edge)) {
+        int& ordinal = ordinals[ aghead( edge ) ];
+        keys.append( edgeKey( edge, ordinal++ ) );
+    }
+
+    return keys;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::cloneGraph
+ * @param graph - the libcgraph graph instance
+ * @return - a copy of the libcgraph graph instance
+ *
+ * Creates a snapshot of the graph including attribute declarations, attribute values, nodes, edges and subgraphs.
+ * Nodes and edges are created in the same order as in the original graph so that the layout of the snapshot
+ * matches the layout of the original graph.  The caller owns the returned graph and must hold the Graphviz library mutex.
+ */
+Agraph_t* QGraphCanvasPrivate::cloneGraph(Agraph_t *graph)
+{
+    Agraph_t* clone = agopen( agnameof( graph ), graph->desc, NULL );
+
+    if ( clone ) {
+        cloneAttributeDeclarations( graph, clone );
+
+        agcopyattr( graph, clone );
+
+        for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+            agcopyattr( node, agnode( clone, agnameof( node ), TRUE ) );
+        }
+
+        for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+            Agnode_t* tail = agnode( clone, agnameof( node ), FALSE );
+            for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge)) {
+                Agnode_t* head = agnode( clone, agnameof( aghead( edge ) ), FALSE );
+                agcopyattr( edge, agedge( clone, tail, head, agnameof( edge ), TRUE ) );
+            }
+        }
+
+        cloneSubgraphs( graph, clone );
+    }
+
+    return clone;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::cloneAttributeDeclarations
+ * @param graph - the libcgraph graph instance
+ * @param clone - the libcgraph graph instance receiving the attribute declarations
+ *
+ * Declares the graph, node and edge attributes of the graph with their default values in the clone.
+ */
+void QGraphCanvasPrivate::cloneAttributeDeclarations(Agraph_t *graph, Agraph_t *clone)
+{
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+    for ( int i=0; i<3; i++ ) {
+        for (Agsym_t* sym = agnxtattr(graph, kinds[i], NULL); sym != NULL; sym = agnxtattr(graph, kinds[i], sym)) {
+            agattr( clone, kinds[i], sym->name, sym->defval );
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::cloneSubgraphs
+ * @param graph - the libcgraph graph or subgraph instance
+ * @param clone - the copy of the libcgraph graph or subgraph instance
+ *
+ * Recursively copies the subgraphs (including clusters) and their attributes and node membership.
+ */
+void QGraphCanvasPrivate::cloneSubgraphs(Agraph_t *graph, Agraph_t *clone)
+{
+    Agraph_t* root = agroot( clone );
+
+    for (Agraph_t* subgraph = agfstsubg(graph); subgraph != NULL; subgraph = agnxtsubg(subgraph)) {
+        Agraph_t* subgraphClone = agsubg( clone, agnameof( subgraph ), TRUE );
+
+        agcopyattr( subgraph, subgraphClone );
+
+        for (Agnode_t* node = agfstnode(subgraph); node != NULL; node = agnxtnode(subgraph, node)) {
+            agsubnode( subgraphClone, agnode( root, agnameof( node ), FALSE ), TRUE );
+        }
+
+        cloneSubgraphs( subgraph, subgraphClone );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setLayoutEngine
+ * @param engine - the Graphviz layout engine
+ *
+ * Sets the Graphviz layout engine.
+ */
+void QGraphCanvasPrivate::setLayoutEngine(QGraphCanvas::LayoutEngine engine)
+{
+    m_layoutEngine = engine;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutEngine
+ * @return - the Graphviz layout engine
+ *
+ * Returns the Graphviz layout engine.
+ */
+QGraphCanvas::LayoutEngine QGraphCanvasPrivate::layoutEngine() const
+{
+    return m_layoutEngine;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setScalableLayoutEngine
+ * @param engine - the Graphviz layout engine used for large graphs
+ * @param nodeThreshold - the number of nodes above which the engine is used (zero to ignore the number of nodes)
+ * @param edgeThreshold - the number of edges above which the engine is used (zero to ignore the number of edges)
+ *
+ * Sets the policy to automatically switch to a scalable layout engine for large graphs.
+ */
+void QGraphCanvasPrivate::setScalableLayoutEngine(QGraphCanvas::LayoutEngine engine, int nodeThreshold, int edgeThreshold)
+{
+    m_scalableLayoutEngine = engine;
+    m_scalableNodeThreshold = nodeThreshold;
+    m_scalableEdgeThreshold = edgeThreshold;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutEngineName
+ * @return - the name of the Graphviz layout engine used to lay out the graph
+ *
+ * Returns the name of the scalable layout engine if the graph exceeds the node or edge threshold and
+ * otherwise the name of the layout engine.
+ */
+QByteArray QGraphCanvasPrivate::layoutEngineName() const
+{
+    if ( m_graph ) {
+        if ( ( m_scalableNodeThreshold > 0 && agnnodes( m_graph ) > m_scalableNodeThreshold ) ||
+             ( m_scalableEdgeThreshold > 0 && agnedges( m_graph ) > m_scalableEdgeThreshold ) ) {
+            return layoutEngineName( m_scalableLayoutEngine );
+        }
+    }
+
+    return layoutEngineName( m_layoutEngine );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutEngineName
+ * @param engine - the Graphviz layout engine
+ * @return - the name of the Graphviz layout engine as passed to gvLayout()
+ *
+ * Returns the name of the Graphviz layout engine.
+ */
+QByteArray QGraphCanvasPrivate::layoutEngineName(QGraphCanvas::LayoutEngine engine)
+{
+    switch ( engine ) {
+    case QGraphCanvas::NeatoEngine: return QByteArray( "neato" );
+    case QGraphCanvas::FdpEngine: return QByteArray( "fdp" );
+    case QGraphCanvas::SfdpEngine: return QByteArray( "sfdp" );
+    case QGraphCanvas::TwopiEngine: return QByteArray( "twopi" );
+    case QGraphCanvas::CircoEngine: return QByteArray( "circo" );
+    default: // include QGraphCanvas::DotEngine
+        return QByteArray( "dot" );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setLayoutCacheDirectory
+ * @param path - the directory where computed layouts are cached (empty disables the layout cache)
+ *
+ * Sets the directory of the layout cache.
+ */
+void QGraphCanvasPrivate::setLayoutCacheDirectory(const QString &path)
+{
+    m_layoutCacheDirectory = path;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutCacheDirectory
+ * @return - the directory where computed layouts are cached
+ *
+ * Returns the directory of the layout cache.
+ */
+QString QGraphCanvasPrivate::layoutCacheDirectory() const
+{
+    return m_layoutCacheDirectory;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutCacheFileName
+ * @param cacheDirectory - the directory of the layout cache
+ * @param gvc - the Graphviz context
+ * @param graph - the libcgraph graph instance
+ * @param engine - the name of the Graphviz layout engine
+ * @return - the layout cache file of the graph (empty if the layout cache is disabled)
+ *
+ * Returns the name of the file within the layout cache directory in which the layout of the graph is stored.
+ */
+QString QGraphCanvasPrivate::layoutCacheFileName(const QString &cacheDirectory, GVC_t *gvc, Agraph_t *graph, const QByteArray &engine)
+{
+    if ( cacheDirectory.isEmpty() )
+        return QString();
+
+    return QDir( cacheDirectory ).filePath( QString::fromLatin1( layoutCacheKey( gvc, graph, engine ) ) + QStringLiteral(".layout") );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutCacheKey
+ * @param gvc - the Graphviz context
+ * @param graph - the libcgraph graph instance
+ * @param engine - the name of the Graphviz layout engine
+ * @return - the hexadecimal SHA-1 hash identifying the layout of the graph
+ *
+ * Computes a hash over the canonicalized graph: the Graphviz version and layout engine, the graph kind, the
+ * attribute declarations with their default values (which include the graph, node and edge attribute settings
+ * of the canvas), and the names and attribute values of the graph, its nodes, edges and subgraphs in creation order.
+ * The graph bounding box written back by a synchronous layout is left out so that the key of a graph does not
+ * change once it has been laid out and matches the key of its snapshots.
+ */
+QByteArray QGraphCanvasPrivate::layoutCacheKey(GVC_t *gvc, Agraph_t *graph, const QByteArray &engine)
+{
+    QCryptographicHash hash( QCryptographicHash::Sha1 );
+
+    // strings are added including their terminating null character to separate them unambiguously
+    const QByteArray header = QByteArray::number( LAYOUT_CACHE_VERSION ) + ' ' + gvcVersion( gvc ) + ' ' + engine
+            + ( agisdirected( graph ) ? " digraph" : " graph" ) + ( agisstrict( graph ) ? " strict" : "" );
+    hash.addData( header.constData(), header.size() + 1 );
+
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+    for ( int i=0; i<3; i++ ) {
+        for (Agsym_t* sym = agnxtattr(graph, kinds[i], NULL); sym != NULL; sym = agnxtattr(graph, kinds[i], sym)) {
+            if ( AGRAPH == kinds[i] && 0 == qstrcmp( sym->name, LAYOUT_OUTPUT_ATTRIBUTE ) )
+                continue;
+            hash.addData( sym->name, qstrlen( sym->name ) + 1 );
+            hash.addData( sym->defval, qstrlen( sym->defval ) + 1 );
+        }
+    }
+
+    hashAttributes( hash, graph, AGRAPH );
+
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        const char* name = agnameof( node );
+        hash.addData( name, qstrlen( name ) + 1 );
+        hashAttributes( hash, node, AGNODE );
+    }
+
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        const QVector< QString > keys = edgeKeys( graph, node );
+        int i( 0 );
+        for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge), i++) {
+            const QByteArray key = keys[i].toUtf8();
+            hash.addData( key.constData(), key.size() + 1 );
+            hashAttributes( hash, edge, AGEDGE );
+        }
+    }
+
+    // subgraphs are visited depth-first
+    QList< Agraph_t* > subgraphs;
+    for (Agraph_t* subgraph = agfstsubg(graph); subgraph != NULL; subgraph = agnxtsubg(subgraph)) {
+        subgraphs.append( subgraph );
+    }
+    while ( ! subgraphs.isEmpty() ) {
+        Agraph_t* subgraph = subgraphs.takeFirst();
+        const char* name = agnameof( subgraph );
+        hash.addData( name, qstrlen( name ) + 1 );
+        hashAttributes( hash, subgraph, AGRAPH );
+        for (Agnode_t* node = agfstnode(subgraph); node != NULL; node = agnxtnode(subgraph, node)) {
+            const char* nodeName = agnameof( node );
+            hash.addData( nodeName, qstrlen( nodeName ) + 1 );
+        }
+        int index( 0 );
+        for (Agraph_t* child = agfstsubg(subgraph); child != NULL; child = agnxtsubg(child)) {
+            subgraphs.insert( index++, child );
+        }
+    }
+
+    return hash.result().toHex();
+}
+
+/**
+ * @brief QGraphCanvasPrivate::hashAttributes
+ * @param hash - the hash being computed
+ * @param object - the libcgraph graph, node or edge instance
+ * @param kind - the libcgraph object kind (AGRAPH, AGNODE or AGEDGE)
+ *
+ * Adds the attribute values of the libcgraph object to the hash except the graph bounding box.
+ */
+void QGraphCanvasPrivate::hashAttributes(QCryptographicHash &hash, void *object, int kind)
+{
+    Agraph_t* graph = ( AGRAPH == kind ) ? (Agraph_t*) object : agroot( object );
+
+    for (Agsym_t* sym = agnxtattr(graph, kind, NULL); sym != NULL; sym = agnxtattr(graph, kind, sym)) {
+        if ( AGRAPH == kind && 0 == qstrcmp( sym->name, LAYOUT_OUTPUT_ATTRIBUTE ) )
+            continue;
+        const char* value = agxget( object, sym );
+        hash.addData( value, qstrlen( value ) + 1 );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::readLayoutCache
+ * @param cacheFileName - the layout cache file of the graph
+ * @param attributes - returns the layout attributes of the graph
+ * @return - whether the layout attributes were read successfully
+ *
+ * Reads the layout attributes from the layout cache file.
+ */
+bool QGraphCanvasPrivate::readLayoutCache(const QString &cacheFileName, LayoutAttributes &attributes)
+{
+    QFile file( cacheFileName );
+
+    if ( ! file.open( QIODevice::ReadOnly ) )
+        return false;
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_8 );
+
+    quint32 magic( 0 ), version( 0 );
+    stream >> magic >> version;
+
+    if ( LAYOUT_CACHE_MAGIC != magic || LAYOUT_CACHE_VERSION != version )
+        return false;
+
+    stream >> attributes.graph >> attributes.nodes >> attributes.edges;
+
+    return ( QDataStream::Ok == stream.status() );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::writeLayoutCache
+ * @param cacheFileName - the layout cache file of the graph (empty if the layout cache is disabled)
+ * @param graph - the libcgraph graph instance that has been laid out
+ *
+ * Writes the layout attributes of the graph to the layout cache file.  The file is written under a temporary
+ * name and then replaces the cache file so that a partially written file is never read.
+ */
+void QGraphCanvasPrivate::writeLayoutCache(const QString &cacheFileName, Agraph_t *graph)
+{
+    if ( cacheFileName.isEmpty() )
+        return;
+
+    const QFileInfo fileInfo( cacheFileName );
+
+    if ( ! QDir().mkpath( fileInfo.absolutePath() ) ) {
+        qWarning() << "WARNING: Unable to create layout cache directory '" << fileInfo.absolutePath() << "'";
+        return;
+    }
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,1,0))
+    // the cache file is replaced atomically when the file is committed
+    QSaveFile file( cacheFileName );
+#else
+    // the process id keeps the temporary files of processes sharing the layout cache apart
+    QFile file( cacheFileName + QStringLiteral(".%1.tmp").arg( QCoreApplication::applicationPid() ) );
+#endif
+
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qWarning() << "WARNING: Unable to write layout cache file '" << cacheFileName << "'";
+        return;
+    }
+
+    const LayoutAttributes attributes = layoutAttributes( graph );
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_8 );
+
+    stream << LAYOUT_CACHE_MAGIC << LAYOUT_CACHE_VERSION;
+    stream << attributes.graph << attributes.nodes << attributes.edges;
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,1,0))
+    if ( QDataStream::Ok != stream.status() )
+        file.cancelWriting();
+
+    if ( ! file.commit() ) {
+        qWarning() << "WARNING: Unable to write layout cache file '" << cacheFileName << "'";
+    }
+#else
+    file.close();
+
+    if ( QDataStream::Ok != stream.status() || QFile::Ok != file.error() ) {
+        qWarning() << "WARNING: Unable to write layout cache file '" << cacheFileName << "'";
+        file.remove();
+        return;
+    }
+
+    // QFile::rename() does not replace an existing file, which another process may have written in the meantime
+    QFile::remove( cacheFileName );
+
+    if ( ! file.rename( cacheFileName ) ) {
+        qWarning() << "WARNING: Unable to write layout cache file '" << cacheFileName << "'";
+        file.remove();
+    }
+#endif
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutAttributes
+ * @param graph - the libcgraph graph instance that has been laid out
+ * @return - the layout attributes of the graph
+ *
+ * Formats the layout of the graph as Graphviz attributes in the same way as the "dot" output format does:
+ * the graph bounding box ("bb"), the node positions and sizes ("pos", "width" and "height") and the edge
+ * spline control points and label positions ("pos" and "lp").  The coordinates are written with 17 significant
+ * digits so that they are restored exactly when the attributes are applied.
+ */
+QGraphCanvasPrivate::LayoutAttributes QGraphCanvasPrivate::layoutAttributes(Agraph_t *graph)
+{
+    LayoutAttributes attributes;
+
+    const boxf bb = GD_bb( graph );
+    attributes.graph << QGraphCanvas::NameValuePair( QStringLiteral("bb"), QStringLiteral("%1,%2,%3,%4").arg( bb.LL.x, 0, 'g', 17 ).arg( bb.LL.y, 0, 'g', 17 ).arg( bb.UR.x, 0, 'g', 17 ).arg( bb.UR.y, 0, 'g', 17 ) );
+
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        const pointf coord = ND_coord( node );
+
+        QGraphCanvas::NameValueList nodeAttributes;
+        nodeAttributes << QGraphCanvas::NameValuePair( QStringLiteral("pos"), QStringLiteral("%1,%2").arg( coord.x, 0, 'g', 17 ).arg( coord.y, 0, 'g', 17 ) );
+        nodeAttributes << QGraphCanvas::NameValuePair( QStringLiteral("width"), QString::number( ND_width( node ), 'g', 17 ) );
+        nodeAttributes << QGraphCanvas::NameValuePair( QStringLiteral("height"), QString::number( ND_height( node ), 'g', 17 ) );
+        attributes.nodes.insert( QString::fromLocal8Bit( agnameof( node ) ), nodeAttributes );
+
+        const QVector< QString > keys = edgeKeys( graph, node );
+        int i( 0 );
+        for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge), i++) {
+            QGraphCanvas::NameValueList edgeAttributes;
+
+            const splines* spline = ED_spl( edge );
+
+            if ( spline ) {
+                QStringList beziers;
+                for( bezier* b = spline->list; b < spline->list + spline->size; b++ ) {
+                    QStringList points;
+                    if ( b->eflag )
+                        points << QStringLiteral("e,%1,%2").arg( b->ep.x, 0, 'g', 17 ).arg( b->ep.y, 0, 'g', 17 );
+                    if ( b->sflag )
+                        points << QStringLiteral("s,%1,%2").arg( b->sp.x, 0, 'g', 17 ).arg( b->sp.y, 0, 'g', 17 );
+                    for ( int i=0; i<b->size; i++ ) {
+                        points << QStringLiteral("%1,%2").arg( b->list[i].x, 0, 'g', 17 ).arg( b->list[i].y, 0, 'g', 17 );
+                    }
+                    beziers << points.join( QStringLiteral(" ") );
+                }
+                edgeAttributes << QGraphCanvas::NameValuePair( QStringLiteral("pos"), beziers.join( QStringLiteral(";") ) );
+            }
+
+            const textlabel_t* textlabel = ED_label( edge );
+
+            if ( textlabel && textlabel->set ) {
+                edgeAttributes << QGraphCanvas::NameValuePair( QStringLiteral("lp"), QStringLiteral("%1,%2").arg( textlabel->pos.x, 0, 'g', 17 ).arg( textlabel->pos.y, 0, 'g', 17 ) );
+            }
+
+            attributes.edges.insert( keys[i], edgeAttributes );
+        }
+    }
+
+    return attributes;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::saveSnapshot
+ * @param fileName - the name of the snapshot file
+ * @return - whether the snapshot was saved successfully
+ *
+ * Writes the graph followed by the states of its node and edge items to the snapshot file.  The states are written
+ * in the order of the nodes and edges of the graph and only if the graph has been laid out.  The file is written
+ * under a temporary name and then renamed so that a partially written file is never read.
+ */
+bool QGraphCanvasPrivate::saveSnapshot(const QString &fileName) const
+{
+    if ( ! m_graph )
+        return false;
+
+    // hidden nodes have no layout and summary nodes are not part of the graph
+    if ( ! m_hiddenNodes.isEmpty() || ! m_summaryNodes.isEmpty() ) {
+        qWarning() << "WARNING: Unable to save graph snapshot file '" << fileName << "' while nodes or clusters are collapsed";
+        return false;
+    }
+
+    const QString tempFileName = fileName + QStringLiteral(".tmp");
+
+    QFile file( tempFileName );
+
+    if ( ! file.open( QIODevice::WriteOnly | QIODevice::Truncate ) ) {
+        qCritical() << "ERROR: Unable to write graph snapshot file '" << tempFileName << "'";
+        return false;
+    }
+
+    QDataStream stream( &file );
+    stream.setVersion( QDataStream::Qt_4_8 );
+
+    stream << SNAPSHOT_MAGIC << SNAPSHOT_VERSION;
+
+    writeSnapshotGraph( stream, m_graph );
+
+    const bool laidOut = ! m_boundingBox.isNull();
+
+    stream << laidOut << m_boundingBox;
+
+    if ( laidOut ) {
+        for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+            QGraphNode* graphNode = QGraphCanvasPrivate::graphNode( node );
+            QGraphNodePrivate::writeState( stream, graphNode ? graphNode->d_func()->state() : QGraphNodePrivate::State() );
+        }
+        for (Agnode_t* node = agfstnode(m_graph); node != NULL; node = agnxtnode(m_graph, node)) {
+            for (Agedge_t* edge = agfstout(m_graph, node); edge != NULL; edge = agnxtout(m_graph, edge)) {
+                QGraphEdge* graphEdge = QGraphCanvasPrivate::graphEdge( edge );
+                QGraphEdgePrivate::writeState( stream, graphEdge ? graphEdge->d_func()->state() : QGraphEdgePrivate::State() );
+            }
+        }
+    }
+
+    file.close();
+
+    if ( QDataStream::Ok != stream.status() || QFile::Ok != file.error() ) {
+        qCritical() << "ERROR: Unable to write graph snapshot file '" << tempFileName << "'";
+        QFile::remove( tempFileName );
+        return false;
+    }
+
+    QFile::remove( fileName );
+
+    return QFile::rename( tempFileName, fileName );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::loadSnapshot
+ * @param fileName - the name of the snapshot file
+ * @return - whether the snapshot was loaded successfully
+ *
+ * Rebuilds the graph of the snapshot file directly with libcgraph, replaces the current graph by it and applies the saved
+ * node and edge states to the newly created items.  The current graph is kept if the snapshot file cannot be read.
+ */
+bool QGraphCanvasPrivate::loadSnapshot(const QString &fileName)
+{
+    QFile file( fileName );
+
+    if ( ! file.open( QIODevice::ReadOnly ) ) {
+        qCritical() << "ERROR: Unable to open graph snapshot file '" << fileName << "'";
+        return false;
+    }
+
+    // read from the memory-mapped file when possible
+    uchar* mapped = ( file.size() > 0 ) ? file.map( 0, file.size() ) : Q_NULLPTR;
+
+    QBuffer buffer;
+    if ( mapped ) {
+        buffer.setData( QByteArray::fromRawData( reinterpret_cast< const char* >( mapped ), file.size() ) );
+        buffer.open( QIODevice::ReadOnly );
+    }
+
+    QDataStream stream( mapped ? static_cast< QIODevice* >( &buffer ) : static_cast< QIODevice* >( &file ) );
+    stream.setVersion( QDataStream::Qt_4_8 );
+
+    quint32 magic( 0 ), version( 0 );
+    stream >> magic >> version;
+
+    if ( SNAPSHOT_MAGIC != magic || SNAPSHOT_VERSION != version ) {
+        qCritical() << "ERROR: Unsupported graph snapshot file '" << fileName << "'";
+        return false;
+    }
+
+    QVector< Agnode_t* > nodes;
+    QVector< Agedge_t* > edges;
+    Agraph_t* graph( Q_NULLPTR );
+
+    {
+        QMutexLocker locker( graphvizMutex() );
+        graph = readSnapshotGraph( stream, nodes, edges );
+    }
+
+    bool laidOut( false );
+    LayoutResult result;
+
+    stream >> laidOut >> result.boundingBox;
+
+    if ( graph && laidOut ) {
+        // label fonts are shared as done by labelFont()
+        QHash< QString, QFont > fonts;
+
+        result.nodes.reserve( nodes.size() );
+        for ( int i=0; i<nodes.size() && QDataStream::Ok == stream.status(); i++ ) {
+            QGraphNodePrivate::State state;
+            QGraphNodePrivate::readState( stream, state );
+            const QString fontKey = state.labelFont.key();
+            if ( fonts.contains( fontKey ) )
+                state.labelFont = fonts.value( fontKey );
+            else
+                fonts.insert( fontKey, state.labelFont );
+            result.nodes.insert( QString::fromLocal8Bit( agnameof( nodes[i] ) ), state );
+        }
+
+        result.edges.reserve( edges.size() );
+        for ( int i=0; i<edges.size() && QDataStream::Ok == stream.status(); i++ ) {
+            QGraphEdgePrivate::State state;
+            QGraphEdgePrivate::readState( stream, state );
+            const QString fontKey = state.font.key();
+            if ( fonts.contains( fontKey ) )
+                state.font = fonts.value( fontKey );
+            else
+                fonts.insert( fontKey, state.font );
+            result.edges.insert( edgeKey( edges[i] ), state );
+        }
+
+        result.valid = true;
+    }
+
+    if ( ! graph || QDataStream::Ok != stream.status() ) {
+        qCritical() << "ERROR: Unable to read graph snapshot file '" << fileName << "'";
+        closeGraph( graph );
+        return false;
+    }
+
+    cancelLoad();
+    releaseGraph();
+
+    m_graph = graph;
+
+    createGraphItems();
+
+    if ( result.valid ) {
+        applyLayout( result );
+    }
+
+    return true;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::writeSnapshotGraph
+ * @param stream - the data stream
+ * @param graph - the libcgraph graph instance
+ *
+ * Writes the graph kind and name, the attribute declarations, the nodes, the edges as node index pairs and the subgraphs.
+ * Only the attribute values differing from the declared defaults are written.
+ */
+void QGraphCanvasPrivate::writeSnapshotGraph(QDataStream &stream, Agraph_t *graph)
+{
+    stream << QByteArray( agnameof( graph ) ) << bool( agisdirected( graph ) ) << bool( agisstrict( graph ) );
+
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+    for ( int k=0; k<3; k++ ) {
+        QList< QPair< QByteArray, QByteArray > > declarations;
+        for (Agsym_t* sym = agnxtattr(graph, kinds[k], NULL); sym != NULL; sym = agnxtattr(graph, kinds[k], sym)) {
+            declarations << qMakePair( QByteArray( sym->name ), QByteArray( sym->defval ) );
+        }
+        stream << declarations;
+    }
+
+    writeSnapshotAttributes( stream, graph, graph, AGRAPH );
+
+    QHash< Agnode_t*, quint32 > nodeIndexes;
+    nodeIndexes.reserve( agnnodes( graph ) );
+
+    stream << quint32( agnnodes( graph ) );
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        nodeIndexes.insert( node, nodeIndexes.size() );
+        stream << QByteArray( agnameof( node ) );
+        writeSnapshotAttributes( stream, graph, node, AGNODE );
+    }
+
+    QHash< Agedge_t*, quint32 > edgeIndexes;
+    edgeIndexes.reserve( agnedges( graph ) );
+
+    stream << quint32( agnedges( graph ) );
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge)) {
+            edgeIndexes.insert( edge, edgeIndexes.size() );
+            stream << nodeIndexes.value( agtail( edge ) ) << nodeIndexes.value( aghead( edge ) ) << QByteArray( agnameof( edge ) );
+            writeSnapshotAttributes( stream, graph, edge, AGEDGE );
+        }
+    }
+
+    writeSnapshotSubgraphs( stream, graph, graph, nodeIndexes, edgeIndexes );
+}
+
+/**
+ * @brief QGraphCanvasPrivate::readSnapshotGraph
+ * @param stream - the data stream
+ * @param nodes - returns the nodes in the order written
+ * @param edges - returns the edges in the order written
+ * @return - the graph read (NULL on failure)
+ *
+ * Creates the graph written by writeSnapshotGraph().  The caller must hold the Graphviz library mutex.
+ */
+Agraph_t* QGraphCanvasPrivate::readSnapshotGraph(QDataStream &stream, QVector< Agnode_t* > &nodes, QVector< Agedge_t* > &edges)
+{
+    QByteArray name;
+    bool directed( true ), strict( false );
+
+    stream >> name >> directed >> strict;
+
+    if ( QDataStream::Ok != stream.status() )
+        return Q_NULLPTR;
+
+    Agdesc_t desc = directed ? Agdirected : Agundirected;
+    desc.strict = strict;
+
+    Agraph_t* graph = agopen( name.data(), desc, NULL );
+
+    if ( ! graph )
+        return Q_NULLPTR;
+
+    QVector< Agsym_t* > symbols[3];
+
+    const int kinds[] = { AGRAPH, AGNODE, AGEDGE };
+    for ( int k=0; k<3; k++ ) {
+        QList< QPair< QByteArray, QByteArray > > declarations;
+        stream >> declarations;
+        for ( int i=0; i<declarations.size(); i++ ) {
+            symbols[k] << agattr( graph, kinds[k], declarations[i].first.data(), declarations[i].second.data() );
+        }
+    }
+
+    readSnapshotAttributes( stream, graph, symbols[0] );
+
+    quint32 nodeCount( 0 );
+    stream >> nodeCount;
+
+    for ( quint32 i=0; i<nodeCount && QDataStream::Ok == stream.status(); i++ ) {
+        QByteArray nodeName;
+        stream >> nodeName;
+        Agnode_t* node = agnode( graph, nodeName.data(), TRUE );
+        readSnapshotAttributes( stream, node, symbols[1] );
+        nodes << node;
+    }
+
+    quint32 edgeCount( 0 );
+    stream >> edgeCount;
+
+    for ( quint32 i=0; i<edgeCount && QDataStream::Ok == stream.status(); i++ ) {
+        quint32 tail( 0 ), head( 0 );
+        QByteArray edgeName;
+        stream >> tail >> head >> edgeName;
+        if ( tail >= (quint32) nodes.size() || head >= (quint32) nodes.size() ) {
+            stream.setStatus( QDataStream::ReadCorruptData );
+            break;
+        }
+        Agedge_t* edge = agedge( graph, nodes[tail], nodes[head], edgeName.isEmpty() ? NULL : edgeName.data(), TRUE );
+        readSnapshotAttributes( stream, edge, symbols[2] );
+        edges << edge;
+    }
+
+    readSnapshotSubgraphs( stream, graph, symbols[0], nodes, edges );
+
+    if ( QDataStream::Ok != stream.status() ) {
+        agclose( graph );
+        return Q_NULLPTR;
+    }
+
+    return graph;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::writeSnapshotAttributes
+ * @param stream - the data stream
+ * @param graph - the root libcgraph graph instance declaring the attributes
+ * @param object - the libcgraph graph, node or edge instance
+ * @param kind - the kind of the libcgraph object (AGRAPH, AGNODE or AGEDGE)
+ *
+ * Writes the attribute values of the object differing from the declared defaults as attribute index/value pairs.
+ */
+void QGraphCanvasPrivate::writeSnapshotAttributes(QDataStream &stream, Agraph_t *graph, void *object, int kind)
+{
+    QList< QPair< quint32, QByteArray > > values;
+
+    quint32 index( 0 );
+    for (Agsym_t* sym = agnxtattr(graph, kind, NULL); sym != NULL; sym = agnxtattr(graph, kind, sym), index++) {
+        const char* value = agxget( object, sym );
+        if ( qstrcmp( value, sym->defval ) != 0 )
+            values << qMakePair( index, QByteArray( value ) );
+    }
+
+    stream << values;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::readSnapshotAttributes
+ * @param stream - the data stream
+ * @param object - the libcgraph graph, node or edge instance
+ * @param symbols - the attribute symbols in declaration order
+ *
+ * Sets the attribute values written by writeSnapshotAttributes() on the object.
+ */
+void QGraphCanvasPrivate::readSnapshotAttributes(QDataStream &stream, void *object, const QVector< Agsym_t* > &symbols)
+{
+    QList< QPair< quint32, QByteArray > > values;
+    stream >> values;
+
+    for ( int i=0; i<values.size(); i++ ) {
+        if ( values[i].first < (quint32) symbols.size() )
+            agxset( object, symbols[ values[i].first ], values[i].second.data() );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::writeSnapshotSubgraphs
+ * @param stream - the data stream
+ * @param root - the root libcgraph graph instance
+ * @param graph - the libcgraph graph instance whose subgraphs are written
+ * @param nodeIndexes - the indexes of the nodes in the order written
+ * @param edgeIndexes - the indexes of the edges in the order written
+ *
+ * Recursively writes the subgraphs of the graph with their attribute values and their node and edge indexes.
+ */
+void QGraphCanvasPrivate::writeSnapshotSubgraphs(QDataStream &stream, Agraph_t *root, Agraph_t *graph,
+                                                 const QHash< Agnode_t*, quint32 > &nodeIndexes, const QHash< Agedge_t*, quint32 > &edgeIndexes)
+{
+    quint32 count( 0 );
+    for (Agraph_t* subgraph = agfstsubg(graph); subgraph != NULL; subgraph = agnxtsubg(subgraph)) {
+        count++;
+    }
+
+    stream << count;
+
+    for (Agraph_t* subgraph = agfstsubg(graph); subgraph != NULL; subgraph = agnxtsubg(subgraph)) {
+        stream << QByteArray( agnameof( subgraph ) );
+        writeSnapshotAttributes( stream, root, subgraph, AGRAPH );
+
+        QVector< quint32 > nodes;
+        QVector< quint32 > edges;
+        for (Agnode_t* node = agfstnode(subgraph); node != NULL; node = agnxtnode(subgraph, node)) {
+            nodes << nodeIndexes.value( node );
+            for (Agedge_t* edge = agfstout(subgraph, node); edge != NULL; edge = agnxtout(subgraph, edge)) {
+                edges << edgeIndexes.value( edge );
+            }
+        }
+        stream << nodes << edges;
+
+        writeSnapshotSubgraphs( stream, root, subgraph, nodeIndexes, edgeIndexes );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::readSnapshotSubgraphs
+ * @param stream - the data stream
+ * @param graph - the libcgraph graph instance whose subgraphs are read
+ * @param symbols - the graph attribute symbols in declaration order
+ * @param nodes - the nodes in the order written
+ * @param edges - the edges in the order written
+ *
+ * Recursively creates the subgraphs written by writeSnapshotSubgraphs().
+ */
+void QGraphCanvasPrivate::readSnapshotSubgraphs(QDataStream &stream, Agraph_t *graph, const QVector< Agsym_t* > &symbols,
+                                                const QVector< Agnode_t* > &nodes, const QVector< Agedge_t* > &edges)
+{
+    quint32 count( 0 );
+    stream >> count;
+
+    for ( quint32 i=0; i<count && QDataStream::Ok == stream.status(); i++ ) {
+        QByteArray name;
+        stream >> name;
+
+        Agraph_t* subgraph = agsubg( graph, name.data(), TRUE );
+        readSnapshotAttributes( stream, subgraph, symbols );
+
+        QVector< quint32 > nodeIndexes;
+        QVector< quint32 > edgeIndexes;
+        stream >> nodeIndexes >> edgeIndexes;
+
+        foreach ( quint32 index, nodeIndexes ) {
+            if ( index < (quint32) nodes.size() )
+                agsubnode( subgraph, nodes[index], TRUE );
+        }
+        foreach ( quint32 index, edgeIndexes ) {
+            if ( index < (quint32) edges.size() )
+                agsubedge( subgraph, edges[index], TRUE );
+        }
+
+        readSnapshotSubgraphs( stream, subgraph, symbols, nodes, edges );
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setLayoutAttributes
+ * @param graph - the libcgraph graph instance
+ * @param attributes - the layout attributes of the graph
+ *
+ * Sets the layout attributes on the graph, its nodes and its edges.
+ */
+void QGraphCanvasPrivate::setLayoutAttributes(Agraph_t *graph, const LayoutAttributes &attributes)
+{
+    const QString nullstr;
+
+    foreach ( const QGraphCanvas::NameValuePair& nameValuePair, attributes.graph ) {
+        agsafeset( graph, nameValuePair.first.toLocal8Bit().data(), nameValuePair.second.toLocal8Bit().data(), nullstr.toLocal8Bit().data() );
+    }
+
+    for (Agnode_t* node = agfstnode(graph); node != NULL; node = agnxtnode(graph, node)) {
+        foreach ( const QGraphCanvas::NameValuePair& nameValuePair, attributes.nodes.value( QString::fromLocal8Bit( agnameof( node ) ) ) ) {
+            agsafeset( node, nameValuePair.first.toLocal8Bit().data(), nameValuePair.second.toLocal8Bit().data(), nullstr.toLocal8Bit().data() );
+        }
+        const QVector< QString > keys = edgeKeys( graph, node );
+        int i( 0 );
+        for (Agedge_t* edge = agfstout(graph, node); edge != NULL; edge = agnxtout(graph, edge), i++) {
+            foreach ( const QGraphCanvas::NameValuePair& nameValuePair, attributes.edges.value( keys[i] ) ) {
+                agsafeset( edge, nameValuePair.first.toLocal8Bit().data(), nameValuePair.second.toLocal8Bit().data(), nullstr.toLocal8Bit().data() );
+            }
+        }
+    }
+}
+
+/**
+ * @brief QGraphCanvasPrivate::setAttributes
+ * @param graphAttributeSettings - a list of name/value pairs specifying graph attribute settings
+ * @param nodeAttributeSettings - a list of name/value pairs specifying node attribute settings
+ * @param edgeAttributeSettings - a list of name/value pairs specifying edge attribute settings
+ *
+ * Sets the default graph, node and edge attributes.
+ */
+void QGraphCanvasPrivate::setAttributes(const QGraphCanvas::NameValueList &graphAttributeSettings,
+                                        const QGraphCanvas::NameValueList &nodeAttributeSettings,
+                                        const QGraphCanvas::NameValueList &edgeAttributeSettings)
+{
+    // configure graph attributes
     foreach ( const QGraphCanvas::NameValuePair& nameValuePair, graphAttributeSettings ) {
         setGraphAttribute( nameValuePair.first, nameValuePair.second );
     }
@@ -209,17 +4315,29 @@ void QGraphCanvasPrivate::setAttributes(const QGraphCanvas::NameValueList &graph
 }
 
 /**
- * @brief QGraphCanvasPrivate::boundingRect
+ * @brief QGraphCanvasPrivate::boundingBox
  * @return - the bounding rectangle of the graph canvas instance
  *
- * This method returns the bounding rectangle of the underlying libcgraph graph instance.
+ * This method returns the bounding rectangle of the graph after the most recently applied layout.
  */
 QRectF QGraphCanvasPrivate::boundingBox() const
+{
+    return m_boundingBox;
+}
+
+/**
+ * @brief QGraphCanvasPrivate::layoutBoundingBox
+ * @param graph - the libcgraph graph instance that has been laid out
+ * @return - the bounding rectangle of the graph
+ *
+ * This method returns the bounding rectangle of the underlying libcgraph graph instance.
+ */
+QRectF QGraphCanvasPrivate::layoutBoundingBox(Agraph_t* graph)
 {
     QRectF sceneRect;
 
     // get bounding box of the graph
-    boxf boundingBox = GD_bb( m_graph );
+    boxf boundingBox = GD_bb( graph );
 
     // the Graphviz rectangle is in terms of lower-left and upper-right so set these attributes in a Qt QRectF class object
     sceneRect.setBottomLeft( QPointF( boundingBox.LL.x, boundingBox.LL.y ) );
@@ -25,15 +25,35 @@
 #define QGRAPHCANVASPRIVATE_H
 
 #include "QGraphCanvas.h"
+#include "QGraphNodePrivate.h"
+#include "QGraphEdgePrivate.h"
 
 #include "graphviz/cgraph.h"
 #include "graphviz/gvc.h"
 
+#include <QAtomicInt>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QPixmap>
+#include <QPointer>
+#include <QSet>
+#include <QSharedPointer>
+#include <QVector>
+
+class QCryptographicHash;
+class QDataStream;
+class QIODevice;
+class QMutex;
+class QPainter;
+class QTimer;
+
 
 class QGraphCanvasPrivate
 {
     Q_DECLARE_PUBLIC(QGraphCanvas)
 
+    friend class QGraphNode;
+    friend class QGraphEdge;
     friend class QGraphNodePrivate;
     friend class QGraphEdgePrivate;
 
@@ -49,24 +69,276 @@ public:
                                  const QGraphCanvas::NameValueList& nodeAttributeSettings,
                                  const QGraphCanvas::NameValueList& edgeAttributeSettings,
                                  QGraphCanvas* parent = 0);
+    explicit QGraphCanvasPrivate(QIODevice* device,
+                                 const QGraphCanvas::NameValueList& graphAttributeSettings,
+                                 const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                                 const QGraphCanvas::NameValueList& edgeAttributeSettings,
+                                 QGraphCanvas* parent = 0);
+    ~QGraphCanvasPrivate();
+
+    // attribute symbols resolved once per graph and cached in a record bound to the root graph
+    enum AttributeSymbol { NodeColorSymbol, NodeFillColorSymbol, NodeStyleSymbol, AttributeSymbolCount };
+
+    static Agsym_t* attributeSymbol(Agraph_t* graph, AttributeSymbol symbol);
+    static Agsym_t* attributeSymbol(Agraph_t* graph, int kind, const QByteArray& name, bool create);
+    static QString attributeValue(void* object, Agsym_t* symbol);
+    static void setAttributeValue(void* object, Agsym_t* symbol, const QByteArray& value);
+
+    // graph load request parsed by a worker thread from either a DOT file or DOT formatted data
+    struct LoadRequest {
+        QString fileName;
+        QByteArray data;
+    };
+
+    // attribute values differing from the default values keyed by the index of the attribute declaration
+    typedef QList< QPair< quint32, QByteArray > > AttributeValues;
+
+    // copy of the visible part of the graph taken on the GUI thread without the Graphviz library; the nodes and edges
+    // are listed in the order of the graph and each subgraph follows its parent subgraph
+    struct GraphSnapshot {
+        struct Edge {
+            int tail;
+            int head;
+            QByteArray name;
+            AttributeValues attributes;
+        };
+        struct Subgraph {
+            int parent;
+            QByteArray name;
+            AttributeValues attributes;
+            QVector< int > nodes;
+        };
+        GraphSnapshot() : valid( false ), desc() { }
+        bool valid;
+        QByteArray name;
+        Agdesc_t desc;
+        QList< QPair< QByteArray, QByteArray > > declarations[3];
+        AttributeValues attributes;
+        QVector< QByteArray > nodes;
+        QVector< AttributeValues > nodeAttributes;
+        QVector< Edge > edges;
+        QVector< Subgraph > subgraphs;
+    };
+
+    // layout request processed by a worker thread against a snapshot of the graph
+    struct LayoutRequest {
+        LayoutRequest() : gvc( Q_NULLPTR ), generation( 0 ), logicalDpiY( 96 ) { }
+        GVC_t* gvc;
+        GraphSnapshot snapshot;
+        int generation;
+        QSharedPointer< QAtomicInt > latestGeneration;
+        int logicalDpiY;
+        QString cacheDirectory;
+        QByteArray engine;
+    };
+
+    // Graphviz layout attributes (positions, spline control points and label positions) of the graph,
+    // nodes and edges keyed by node name and edge key as stored in the layout cache
+    struct LayoutAttributes {
+        QGraphCanvas::NameValueList graph;
+        QHash< QString, QGraphCanvas::NameValueList > nodes;
+        QHash< QString, QGraphCanvas::NameValueList > edges;
+    };
+
+    // node and edge geometries copied from the libcgraph graph after layout with their node names and edge keys
+    struct LayoutGeometry {
+        LayoutGeometry() : valid( false ) { }
+        bool valid;
+        QRectF boundingBox;
+        QVector< QString > nodeKeys;
+        QVector< QGraphNodePrivate::Geometry > nodes;
+        QVector< QString > edgeKeys;
+        QVector< QGraphEdgePrivate::Geometry > edges;
+    };
+
+    // node and edge states after layout keyed by node name and edge key
+    struct LayoutResult {
+        LayoutResult() : generation( 0 ), valid( false ) { }
+        int generation;
+        bool valid;
+        QRectF boundingBox;
+        QHash< QString, QGraphNodePrivate::State > nodes;
+        QHash< QString, QGraphEdgePrivate::State > edges;
+    };
+
+    // packed uniform grid of the scene bounding rectangles of the visible nodes and edges in stacking order; the
+    // indexes of the items overlapping each cell are stored contiguously in ascending order starting at the cell offset
+    struct ItemIndex {
+        ItemIndex() : valid( false ), columns( 0 ), rows( 0 ) { }
+        bool valid;
+        QRectF bounds;
+        int columns;
+        int rows;
+        QSizeF cellSize;
+        QVector< int > cellOffsets;
+        QVector< int > cellItems;
+        QVector< QGraphicsItem* > items;
+        QVector< QRectF > itemRects;
+    };
+
 private:
 
+    void init();
+
     QRectF boundingBox() const;
 
     Agraph_t* graph() const;
 
+    void loadGraphAsync(const LoadRequest& request,
+                        const QGraphCanvas::NameValueList& graphAttributeSettings,
+                        const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                        const QGraphCanvas::NameValueList& edgeAttributeSettings);
+    void cancelLoad();
+    bool isLoading() const;
+    void handleGraphLoaded(QFutureWatcher< Agraph_t* >* watcher);
+    void createGraphItemsSlice();
+    void releaseGraph();
+    void freeLayout();
+    void clearGraph();
+    bool reloadGraph(QIODevice* device,
+                     const QGraphCanvas::NameValueList& graphAttributeSettings,
+                     const QGraphCanvas::NameValueList& nodeAttributeSettings,
+                     const QGraphCanvas::NameValueList& edgeAttributeSettings);
+
+    static Agraph_t* loadGraph(const LoadRequest& request);
+    static void closeGraph(Agraph_t* graph);
+
     void updateLayout();
+    void updateLayoutAsync();
+    void updateLayoutIncremental();
+    void handleLayoutFinished();
+    void applyLayout(const LayoutResult& result);
+    int nextGeneration();
+
+    static LayoutResult computeLayout(const LayoutRequest& request);
+    static LayoutGeometry cachedLayout(GVC_t* gvc, Agraph_t* graph, const QString& cacheFileName, int logicalDpiY);
+    static LayoutGeometry layoutGeometry(Agraph_t* graph, int logicalDpiY);
+    static LayoutResult layoutResult(const LayoutGeometry& geometry);
+    static QRectF layoutBoundingBox(Agraph_t* graph);
+    static QString edgeKey(Agedge_t* edge);
+    static QString edgeKey(Agedge_t* edge, int ordinal);
+    static QVector< QString > edgeKeys(Agraph_t* graph, Agnode_t* tail);
+    static Agraph_t* cloneGraph(Agraph_t* graph);
+    static Agraph_t* createGraph(const GraphSnapshot& snapshot);
+    static void cloneAttributeDeclarations(Agraph_t* graph, Agraph_t* clone);
+    static void cloneSubgraphs(Agraph_t* graph, Agraph_t* clone);
+    static QMutex* graphvizMutex();
+    static GVC_t* acquireContext();
+    static void releaseContext(GVC_t* gvc);
+    static Agraph_t* readGraph(QIODevice* device);
+    static int logicalDpiY();
+    static QFont labelFont(const QString& fontName, int pixelSize);
+
+    void setLayoutEngine(QGraphCanvas::LayoutEngine engine);
+    QGraphCanvas::LayoutEngine layoutEngine() const;
+    void setScalableLayoutEngine(QGraphCanvas::LayoutEngine engine, int nodeThreshold, int edgeThreshold);
+    QByteArray layoutEngineName() const;
+    static QByteArray layoutEngineName(QGraphCanvas::LayoutEngine engine);
+
+    void setLayoutCacheDirectory(const QString& path);
+    QString layoutCacheDirectory() const;
+
+    static QString layoutCacheFileName(const QString& cacheDirectory, GVC_t* gvc, Agraph_t* graph, const QByteArray& engine);
+    static QByteArray layoutCacheKey(GVC_t* gvc, Agraph_t* graph, const QByteArray& engine);
+    static void hashAttributes(QCryptographicHash& hash, void* object, int kind);
+    static bool readLayoutCache(const QString& cacheFileName, LayoutAttributes& attributes);
+    static void writeLayoutCache(const QString& cacheFileName, Agraph_t* graph);
+    static LayoutAttributes layoutAttributes(Agraph_t* graph);
+
+    bool saveSnapshot(const QString& fileName) const;
+    bool loadSnapshot(const QString& fileName);
+    static void writeSnapshotGraph(QDataStream& stream, Agraph_t* graph);
+    static Agraph_t* readSnapshotGraph(QDataStream& stream, QVector< Agnode_t* >& nodes, QVector< Agedge_t* >& edges);
+    static void writeSnapshotAttributes(QDataStream& stream, Agraph_t* graph, void* object, int kind);
+    static void readSnapshotAttributes(QDataStream& stream, void* object, const QVector< Agsym_t* >& symbols);
+    static void writeSnapshotSubgraphs(QDataStream& stream, Agraph_t* root, Agraph_t* graph,
+                                       const QHash< Agnode_t*, quint32 >& nodeIndexes, const QHash< Agedge_t*, quint32 >& edgeIndexes);
+    static void readSnapshotSubgraphs(QDataStream& stream, Agraph_t* graph, const QVector< Agsym_t* >& symbols,
+                                      const QVector< Agnode_t* >& nodes, const QVector< Agedge_t* >& edges);
+    static void setLayoutAttributes(Agraph_t* graph, const LayoutAttributes& attributes);
 
     void setAttributes(const QGraphCanvas::NameValueList& graphAttributeSettings,
                        const QGraphCanvas::NameValueList& nodeAttributeSettings,
                        const QGraphCanvas::NameValueList& edgeAttributeSettings);
 
+    Agsym_t* attributeSymbol(int kind, const QString& name, bool create);
+
     void setGraphAttribute(const QString &name, const QString &value);
     void setNodeAttribute(const QString &name, const QString &value);
     void setEdgeAttribute(const QString &name, const QString &value);
 
+    void createGraphItems();
+    void createGraphItems(Agnode_t* node);
+    bool addGraphNode(QGraphNode* node);
+    bool addGraphEdge(QGraphEdge* edge);
+    bool addGraphEdge(QGraphEdge* edge, const QString& key);
+
+    QGraphNode* graphNode(const QString& name) const;
+    QList< QGraphEdge* > graphEdges(QGraphNode* tail, QGraphNode* head) const;
+    static QGraphNode* graphNode(Agnode_t* node);
+    static QGraphEdge* graphEdge(Agedge_t* edge);
+    static void bindItem(void* object, QGraphicsObject* item);
+    static QGraphicsObject* boundItem(void* object);
+    static void unbindItem(void* object, QGraphicsObject* item);
+
+    void itemSelectionChanged(QGraphNode* node, bool selected);
+    void itemSelectionChanged(QGraphEdge* edge, bool selected);
+    void itemDestroyed(QGraphNode* node);
+    void itemDestroyed(QGraphEdge* edge);
+    void emitSelectionDelta();
+
     void showGrid(bool shown);
     bool drawGrid() const { return m_drawGrid; }
+    void paintGrid(QPainter* painter, const QRectF& exposedRect);
+
+    void setGridCached(bool cached) { m_gridCached = cached; }
+    bool isGridCached() const { return m_gridCached; }
+
+    void setLevelOfDetailThresholds(qreal labelThreshold, qreal shapeThreshold);
+    qreal labelLevelOfDetailThreshold() const { return m_labelLevelOfDetailThreshold; }
+    qreal shapeLevelOfDetailThreshold() const { return m_shapeLevelOfDetailThreshold; }
+
+    void setEdgeHitTestMode(QGraphCanvas::EdgeHitTestMode mode) { m_edgeHitTestMode = mode; }
+    QGraphCanvas::EdgeHitTestMode edgeHitTestMode() const { return m_edgeHitTestMode; }
+
+    void setNodeAttributes(const QVector< QPair< QGraphNode*, QGraphCanvas::NameValueList > >& attributeSettings);
+    void setNodeColors(const QVector< QGraphNode* >& nodes, const QVector< qreal >& values,
+                       const QGradientStops& colorMap, qreal minimum, qreal maximum);
+    static QColor colorMapColor(const QGradientStops& colorMap, qreal position);
+
+    void setSelectionColor(const QColor& color) { m_selectionColor = color; }
+    QColor selectionColor() const { return m_selectionColor; }
+
+    void setStaticItemIndex(bool enabled);
+    bool isStaticItemIndex() const { return m_staticItemIndex; }
+    void invalidateItemIndex();
+    void buildItemIndex() const;
+    QList< QGraphicsItem* > graphItems(const QRectF& rect) const;
+    QGraphicsItem* graphItemAt(const QPointF& pos) const;
+    static int bspTreeDepth(int itemCount);
+
+    void collapseNode(QGraphNode* node);
+    void expandNode(QGraphNode* node);
+    bool isCollapsed(QGraphNode* node) const;
+    QGraphNode* collapseCluster(const QString& name);
+    void expandCluster(const QString& name);
+    bool isClusterCollapsed(const QString& name) const { return m_collapsedClusters.contains( name ); }
+    void setExpansionDepth(int depth);
+    int expansionDepth() const { return m_expansionDepth; }
+    void initializeVisibility();
+    void collapseToDepth(const QList< Agnode_t* >& roots, int depth, bool unreachedOnly);
+    QList< Agnode_t* > rootNodes() const;
+    QSet< Agnode_t* > unreachedNodes() const;
+    void hideGraphItems(const QList< Agnode_t* >& nodes);
+    bool showGraphItems(const QList< Agnode_t* >& nodes);
+    void showGraphNode(Agnode_t* node);
+    void showGraphEdge(Agedge_t* edge);
+    Agnode_t* canonicalNode(Agnode_t* node) const;
+    GraphSnapshot layoutSnapshot() const;
+    static void snapshotAttributes(void* object, int kind, const QVector< quint32 >& indexes, bool all, AttributeValues& values);
+    static void snapshotSubgraphs(Agraph_t* graph, int parent, const QHash< Agnode_t*, int >& nodeIndexes, const QVector< quint32 >& indexes, GraphSnapshot& snapshot);
+    static void declareMissingAttributes(Agraph_t* graph, Agraph_t* clone);
+    static Agraph_t* findSubgraph(Agraph_t* graph, const QByteArray& name);
 
 protected:
 
@@ -76,7 +348,73 @@ private:
 
     GVC_t* m_gvc;
     Agraph_t* m_graph;
+    bool m_graphLaidOut;
     bool m_drawGrid;
+    bool m_gridCached;
+    QPixmap m_gridTile;
+    qreal m_labelLevelOfDetailThreshold;
+    qreal m_shapeLevelOfDetailThreshold;
+    QGraphCanvas::EdgeHitTestMode m_edgeHitTestMode;
+    QColor m_selectionColor;
+
+    // spatial index of the nodes and edges built after layout when the static item index is enabled
+    bool m_staticItemIndex;
+    mutable ItemIndex m_itemIndex;
+
+    // attribute symbols of the graph keyed by name for the graph, node and edge attributes
+    QHash< QString, Agsym_t* > m_attributeSymbols[3];
+
+    // graph items keyed by node name and edge key
+    QHash< QString, QPointer< QGraphNode > > m_nodeItems;
+    QHash< QString, QPointer< QGraphEdge > > m_edgeItems;
+
+    // edge items keyed by their libcgraph tail and head nodes
+    QMultiHash< QPair< Agnode_t*, Agnode_t* >, QPointer< QGraphEdge > > m_edgeItemsByNodes;
+
+    // collapsed nodes, the nodes they hide, the collapsed clusters keyed by name with their summary nodes, the nodes of
+    // the collapsed clusters and all hidden nodes; the items of hidden nodes and of their edges are created when the
+    // nodes are revealed
+    QSet< Agnode_t* > m_collapsedNodes;
+    QSet< Agnode_t* > m_unreachedNodes;
+    QHash< QString, Agnode_t* > m_collapsedClusters;
+    QSet< Agnode_t* > m_clusterNodes;
+    QSet< Agnode_t* > m_hiddenNodes;
+    int m_expansionDepth;
+
+    // summary nodes of the collapsed clusters and their edges to proxy nodes named after the connected graph nodes
+    Agraph_t* m_summaryGraph;
+    QSet< Agnode_t* > m_summaryNodes;
+
+    // selection changes since the last selectionDelta() signal
+    QSet< QGraphNode* > m_addedNodes;
+    QSet< QGraphNode* > m_removedNodes;
+    QSet< QGraphEdge* > m_addedEdges;
+    QSet< QGraphEdge* > m_removedEdges;
+
+    // layout state
+    QRectF m_boundingBox;
+    qreal m_layoutMirrorY;
+    QList< QString > m_pendingNodes;
+    QList< QString > m_pendingEdges;
+    int m_generation;
+    QSharedPointer< QAtomicInt > m_latestGeneration;
+    QFutureWatcher< LayoutResult >* m_layoutWatcher;
+    QString m_layoutCacheDirectory;
+    QGraphCanvas::LayoutEngine m_layoutEngine;
+    QGraphCanvas::LayoutEngine m_scalableLayoutEngine;
+    int m_scalableNodeThreshold;
+    int m_scalableEdgeThreshold;
+
+    // asynchronous load state
+    QFutureWatcher< Agraph_t* >* m_loadWatcher;
+    QList< QFutureWatcher< Agraph_t* >* > m_loadWatchers;
+    QTimer* m_loadTimer;
+    Agnode_t* m_loadNode;
+    int m_loadedNodes;
+    int m_loadTotalNodes;
+    QGraphCanvas::NameValueList m_loadGraphAttributes;
+    QGraphCanvas::NameValueList m_loadNodeAttributes;
+    QGraphCanvas::NameValueList m_loadEdgeAttributes;
 
 };
 
@@ -29,13 +29,16 @@
 
 #include "common/argonavis-lib-config.h"
 
-#include <QApplication>
-#include <QDesktopWidget>
+#include <QDataStream>
 #include <QFontMetricsF>
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 
 #include <cmath>
 
+// width of the outline around the edge path making it easier for the user to select edges
+static const qreal SELECTION_WIDTH = 20.0;
+
 /**
  * @brief QGraphEdgePrivate::QGraphEdgePrivate
  * @param name - the edge label
@@ -48,13 +51,11 @@
  */
 QGraphEdgePrivate::QGraphEdgePrivate(const QString& name, QGraphCanvasPrivate* canvas, QGraphNodePrivate* head, QGraphNodePrivate* tail, QGraphEdge *parent)
     : q_ptr( parent )
+    , m_fontSize( 0.0 )
 {
     m_edge = agedge( canvas->graph(), head->node(), tail->node(), name.toLocal8Bit().data(), TRUE );
 
-    setAttribute( QStringLiteral("label"), name.toLocal8Bit().data() );
-
-    QDesktopWidget* desktopWidget = QApplication::desktop();
-    m_logicalDpiY = ( desktopWidget ) ? desktopWidget->logicalDpiY() : 96.0;
+    QGraphCanvasPrivate::setAttributeValue( m_edge, canvas->attributeSymbol( AGEDGE, QStringLiteral("label"), true ), name.toLocal8Bit() );
 }
 
 /**
@@ -67,6 +68,7 @@ QGraphEdgePrivate::QGraphEdgePrivate(const QString& name, QGraphCanvasPrivate* c
 QGraphEdgePrivate::QGraphEdgePrivate(Agedge_t *edge, QGraphEdge *parent)
     : q_ptr( parent )
     , m_edge( edge )
+    , m_fontSize( 0.0 )
 {
 
 }
@@ -112,8 +114,16 @@ QPolygonF QGraphEdgePrivate::createNormalArrow(const QLineF &line)
  */
 void QGraphEdgePrivate::setAttribute(const QString &name, const QString &value)
 {
-    const QString nullstr;
-    agsafeset( m_edge, name.toLocal8Bit().data(), value.toLocal8Bit().data(), nullstr.toLocal8Bit().data() );
+    Q_Q(QGraphEdge);
+
+    // use the attribute symbols cached by the canvas when the edge has been added to one
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( q->scene() );
+
+    Agsym_t* symbol = ( canvas && canvas->d_func()->graph() == agroot( m_edge ) )
+            ? canvas->d_func()->attributeSymbol( AGEDGE, name, true )
+            : QGraphCanvasPrivate::attributeSymbol( agraphof( m_edge ), AGEDGE, name.toLocal8Bit(), true );
+
+    QGraphCanvasPrivate::setAttributeValue( m_edge, symbol, value.toLocal8Bit() );
 }
 
 /**
@@ -123,36 +133,292 @@ void QGraphEdgePrivate::setAttribute(const QString &name, const QString &value)
  */
 void QGraphEdgePrivate::updateState()
 {
-    Q_Q(QGraphEdge);
+    setState( layoutState( m_edge, QGraphCanvasPrivate::logicalDpiY() ) );
+}
+
+/**
+ * @brief QGraphEdgePrivate::layoutGeometry
+ * @param e - the libcgraph edge instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the edge label font
+ * @return - the edge geometry after layout
+ *
+ * Copies the splines and the label of the libcgraph edge in the Qt coordinate system.  This method must be
+ * serialized with all other libcgraph accesses.
+ */
+QGraphEdgePrivate::Geometry QGraphEdgePrivate::layoutGeometry(Agedge_t* e, int logicalDpiY)
+{
+    // mirror the Graphviz y coordinate values within the graph bounding box (the lower-left corner of the bounding
+    // box is the origin unless the layout engine has been told not to translate the drawing)
+    const boxf bb = GD_bb( agraphof( e ) );
+
+    return layoutGeometry( e, logicalDpiY, bb.LL.y + bb.UR.y );
+}
+
+/**
+ * @brief QGraphEdgePrivate::layoutGeometry
+ * @param e - the libcgraph edge instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the edge label font
+ * @param mirrorY - the sum of the Graphviz y coordinate values mapped to each other by the Qt coordinate system
+ * @return - the edge geometry after layout
+ *
+ * Copies the edge geometry as above but mirrors the Graphviz y coordinate values about the given value instead of
+ * the bounding box of the graph, which places the edge in the coordinate system of another layout.
+ */
+QGraphEdgePrivate::Geometry QGraphEdgePrivate::layoutGeometry(Agedge_t* e, int logicalDpiY, qreal mirrorY)
+{
+    Geometry geometry;
+
+    geometry.logicalDpiY = logicalDpiY;
+
+    // get the Cubic
+    const splines* spline = ED_spl( e );
+
+    // edges are not routed when the "splines" graph attribute is empty or "none"
+    if ( spline ) {
+        // NOTE: all points are expressed in the global coordinate system
+        for( bezier* b = spline->list; b < spline->list + spline->size; b++ ) {
+            if ( b->size % 3 != 1 )
+                continue;  // Cubic Bezier Spline doesn't have the correct number of points
+            Spline s;
+            for ( int i=0; i<b->size; i++ ) {
+                s.points.append( point( b->list[i], mirrorY ) );
+            }
+            s.sflag = b->sflag;
+            if ( s.sflag )
+                s.sp = point( b->sp, mirrorY );
+            s.eflag = b->eflag;
+            if ( s.eflag )
+                s.ep = point( b->ep, mirrorY );
+            geometry.splines.append( s );
+        }
+    }
+
+    const textlabel_t* textlabel = ED_label( e );
+
+    if ( textlabel ) {
+        geometry.hasLabel = true;
+        geometry.label.text = QString( textlabel->text );
+        // center position of the label is either explicited defined in the label or set to the origin
+        geometry.label.center = ( textlabel->set ) ? point( textlabel->pos, mirrorY ) : QPointF( 0.0, 0.0 );
+        geometry.label.fontName = QString( textlabel->fontname );
+        geometry.label.fontSize = textlabel->fontsize;
+        geometry.label.fontColor = QColor( textlabel->fontcolor );
+        geometry.label.valign = textlabel->valign;
+        geometry.label.space = QSizeF( textlabel->space.x, textlabel->space.y );
+    }
+
+    return geometry;
+}
 
-    QDesktopWidget* desktopWidget = QApplication::desktop();
-    m_logicalDpiY = ( desktopWidget ) ? desktopWidget->logicalDpiY() : 96.0;
+/**
+ * @brief QGraphEdgePrivate::layoutState
+ * @param geometry - the edge geometry after layout
+ * @return - the edge state after layout
+ *
+ * Computes the edge state (position and painter paths in local graphics item coordinates) from the edge geometry.
+ * This method does not access libcgraph and thus may be invoked concurrently from worker threads.
+ */
+QGraphEdgePrivate::State QGraphEdgePrivate::layoutState(const Geometry& geometry)
+{
+    State state;
 
-    // first generate painter paths for the edge and edge label in global coordinates
-    QPainterPath localPath = path();
-    QPainterPath localLabelPath = labelPath( m_fontColor, m_fontSize, m_font );
+    // first generate the painter path for the edge and the edge label rectangle in global coordinates
+    QPainterPath localPath = path( geometry );
+    QRectF localLabelRect = labelRect( geometry, state.fontColor, state.fontSize, state.font );
 
     // generate painter paths for the edge arrows
-    QPainterPath arrowPaths = arrowPath();
+    QPainterPath arrowPaths = arrowPath( geometry );
 
-    // create a path containing both edge path and edge label path to determine bounding box of combined paths
+    // create a path containing both edge path and edge label rectangle to determine bounding box of combined paths
     QPainterPath jointPath( localPath );
-    jointPath.addPath( localLabelPath );
+    if ( ! localLabelRect.isNull() )
+        jointPath.addRect( localLabelRect );
 
     // generate bounding box in global coordinates so that the center of this bounding bpx is used to set the edge's origin position in global coordinates
     QRectF boundingBox = jointPath.boundingRect();
 
+    // the graphics item origin position is the global bounding box center
+    state.pos = boundingBox.center();
+
+    // map the global bounding box and painter paths to local graphics item coordinates
+    const QPointF offset = -state.pos;
+    state.boundingBox = boundingBox.translated( offset );
+    state.path = localPath.translated( offset );
+    state.labelRect = localLabelRect.translated( offset );
+
+    // the label text is laid out once when first drawn instead of being converted to a painter path
+    if ( geometry.hasLabel && ! geometry.label.text.isEmpty() ) {
+        state.labelText.setText( geometry.label.text );
+        state.labelText.setTextFormat( Qt::PlainText );
+    }
+    state.arrowPath = arrowPaths.translated( offset );
+
+    // straight polylines through the end points of the Bezier segments used when zoomed out
+    foreach( const Spline& s, geometry.splines ) {
+        QPolygonF polyline;
+        if ( s.sflag )
+            polyline.append( s.sp );
+        for ( int i=0; i<s.points.size(); i+=3 ) {
+            polyline.append( s.points[i] );
+        }
+        if ( s.eflag )
+            polyline.append( s.ep );
+        state.polylines.append( polyline.translated( offset ) );
+    }
+
+    return state;
+}
+
+/**
+ * @brief QGraphEdgePrivate::layoutState
+ * @param e - the libcgraph edge instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the edge label font
+ * @return - the edge state after layout
+ *
+ * Computes the edge state from the layout of the libcgraph edge.
+ */
+QGraphEdgePrivate::State QGraphEdgePrivate::layoutState(Agedge_t* e, int logicalDpiY)
+{
+    return layoutState( layoutGeometry( e, logicalDpiY ) );
+}
+
+/**
+ * @brief QGraphEdgePrivate::setState
+ * @param state - the edge state after layout
+ *
+ * Applies the edge state computed by layoutState() to the QGraphEdge instance.  The caller is
+ * responsible for invoking QGraphicsItem::prepareGeometryChange() beforehand.
+ */
+void QGraphEdgePrivate::setState(const State &state)
+{
+    Q_Q(QGraphEdge);
+
     // set the graphics item origin position to the global bounding box center
-    q->setPos( boundingBox.center() );
-
-    // map the global bounding box to local graphics item coordinates
-    m_boundingBox = q->mapRectFromScene( boundingBox );
-    // map the edge painter path to local graphics item coordinates
-    m_path = q->mapFromScene( localPath );
-    // map the edge label painter path to local graphics item coordinates
-    m_labelPath = q->mapFromScene( localLabelPath );
-    // map the edge arrow painter path to the local graphics item coordinates
-    m_arrowPath = q->mapFromScene( arrowPaths );
+    q->setPos( state.pos );
+
+    m_boundingBox = state.boundingBox;
+    m_path = state.path;
+    m_labelRect = state.labelRect;
+    m_labelText = state.labelText;
+    m_arrowPath = state.arrowPath;
+    m_polylines = state.polylines;
+
+    // invalidate the hit testing geometry
+    m_selectionShape = QPainterPath();
+    m_hitTestPolylines.clear();
+    m_font = state.font;
+    m_fontColor = state.fontColor;
+    m_fontSize = state.fontSize;
+}
+
+/**
+ * @brief QGraphEdgePrivate::state
+ * @return - the current edge state
+ *
+ * Returns the edge state last applied by setState().
+ */
+QGraphEdgePrivate::State QGraphEdgePrivate::state() const
+{
+    Q_Q(const QGraphEdge);
+
+    State state;
+
+    state.pos = q->pos();
+    state.path = m_path;
+    state.labelRect = m_labelRect;
+    state.labelText = m_labelText;
+    state.arrowPath = m_arrowPath;
+    state.polylines = m_polylines;
+    state.font = m_font;
+    state.fontColor = m_fontColor;
+    state.fontSize = m_fontSize;
+    state.boundingBox = m_boundingBox;
+
+    return state;
+}
+
+/**
+ * @brief QGraphEdgePrivate::paint
+ * @param painter - the painter instance to be used for drawing the edge in edge coordinates
+ * @param state - the edge state
+ * @param options - the level of detail thresholds and selection color
+ * @param selected - whether the edge is drawn as selected
+ *
+ * Draws the edge from its state.  Below the level of detail thresholds the label is skipped and the edge is drawn
+ * as straight polylines.  This method does not access the QGraphEdge instance and thus may be invoked from worker
+ * threads painting on a QImage provided the label text of the state is not shared with the GUI thread.
+ */
+void QGraphEdgePrivate::paint(QPainter *painter, const State &state, const QGraphNodePrivate::PaintOptions &options, bool selected)
+{
+    // determine the level of detail from the scale of the painter transform
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+
+    painter->save();
+
+    QPen pPen( painter->pen() );
+
+    // highlight selected edges with a wider pen of the selection color
+    if ( selected ) {
+        QPen pen( pPen );
+        pen.setColor( options.selectionColor );
+        pen.setWidthF( qMax( pPen.widthF(), 1.0 ) * 2.0 );
+        painter->setPen( pen );
+    }
+
+    if ( lod < options.shapeThreshold ) {
+        // draw straight polylines instead of the Bezier splines and arrows
+        foreach( const QPolygonF& polyline, state.polylines ) {
+            painter->drawPolyline( polyline );
+        }
+    }
+    else {
+        painter->drawPath( state.path );
+
+        painter->setBrush( painter->pen().color() );
+
+        painter->drawPath( state.arrowPath );
+    }
+
+    if ( ! state.labelText.text().isEmpty() && lod >= options.labelThreshold ) {
+        painter->setPen( state.fontColor );
+        painter->setFont( state.font );
+        painter->drawStaticText( state.labelRect.topLeft(), state.labelText );
+    }
+
+    painter->restore();
+}
+
+/**
+ * @brief QGraphEdgePrivate::writeState
+ * @param stream - the data stream
+ * @param state - the edge state
+ *
+ * Writes the edge state to the data stream.
+ */
+void QGraphEdgePrivate::writeState(QDataStream &stream, const State &state)
+{
+    stream << state.pos << state.path << state.labelRect << state.labelText.text() << state.arrowPath << state.polylines;
+    stream << state.font << state.fontColor << state.fontSize << state.boundingBox;
+}
+
+/**
+ * @brief QGraphEdgePrivate::readState
+ * @param stream - the data stream
+ * @param state - returns the edge state
+ *
+ * Reads the edge state written by writeState() from the data stream.
+ */
+void QGraphEdgePrivate::readState(QDataStream &stream, State &state)
+{
+    QString labelText;
+
+    stream >> state.pos >> state.path >> state.labelRect >> labelText >> state.arrowPath >> state.polylines;
+    stream >> state.font >> state.fontColor >> state.fontSize >> state.boundingBox;
+
+    if ( ! labelText.isEmpty() ) {
+        state.labelText.setText( labelText );
+        state.labelText.setTextFormat( Qt::PlainText );
+    }
 }
 
 /**
@@ -164,79 +430,131 @@ void QGraphEdgePrivate::updateState()
  */
 QRectF QGraphEdgePrivate::boundingRect() const
 {
-    return m_boundingBox;
+    // include the wider selection pen so that selecting the edge does not change its geometry
+    return m_boundingBox.adjusted( -1.0, -1.0, 1.0, 1.0 );
 }
 
 /**
- * @brief QGraphEdgePrivate::height
- * @return - the height of the edge bounding box
+ * @brief QGraphEdgePrivate::selectionShape
+ * @return - the outline of the edge and edge label
  *
- * Returns the height of the edge bounding box.
+ * Returns the outline of the edge path and edge label rectangle widened by a painter path stroker, which makes a slightly
+ * larger area to make it easier for the user to select edges.  The outline is computed on first use after each state change.
  */
-double QGraphEdgePrivate::height() const
+QPainterPath QGraphEdgePrivate::selectionShape() const
 {
-    boxf bb = GD_bb( agraphof( m_edge ) );
+    if ( m_selectionShape.isEmpty() && ( ! m_path.isEmpty() || ! m_labelRect.isNull() ) ) {
+        // initialize a painter path stroker to generate an outline of the edge and edge label painter paths
+        QPainterPathStroker stroker;
+        stroker.setWidth( SELECTION_WIDTH );
+
+        // create a path containing both edge path, edge arrow path and edge label bounding box
+        QPainterPath jointPath( m_path );
+        if ( ! m_labelRect.isNull() )
+            jointPath.addRect( m_labelRect );
 
-    return ( bb.UR.y - bb.LL.y );
+        m_selectionShape = stroker.createStroke( jointPath );
+    }
+
+    return m_selectionShape;
+}
+
+/**
+ * @brief QGraphEdgePrivate::polylineContains
+ * @param point - the point in local graphics item coordinates
+ * @return - whether the point hits the edge
+ *
+ * Tests whether the point lies within half the selection width of the flattened edge path or within the edge label rectangle.
+ * The flattened edge path is computed on first use after each state change.
+ */
+bool QGraphEdgePrivate::polylineContains(const QPointF &point) const
+{
+    if ( m_labelRect.contains( point ) )
+        return true;
+
+    const qreal radius = SELECTION_WIDTH / 2.0;
+
+    if ( ! m_boundingBox.adjusted( -radius, -radius, radius, radius ).contains( point ) )
+        return false;
+
+    if ( m_hitTestPolylines.isEmpty() )
+        m_hitTestPolylines = m_path.toSubpathPolygons();
+
+    const qreal radiusSquared = radius * radius;
+
+    foreach( const QPolygonF& polyline, m_hitTestPolylines ) {
+        for ( int i=1; i<polyline.size(); i++ ) {
+            // squared distance between the point and the line segment
+            const QPointF p1 = polyline[i-1];
+            const QPointF d = polyline[i] - p1;
+            const qreal lengthSquared = d.x() * d.x() + d.y() * d.y();
+            qreal t = 0.0;
+            if ( lengthSquared > 0.0 )
+                t = qBound( 0.0, ( ( point.x() - p1.x() ) * d.x() + ( point.y() - p1.y() ) * d.y() ) / lengthSquared, 1.0 );
+            const QPointF v = point - ( p1 + t * d );
+            if ( v.x() * v.x() + v.y() * v.y() <= radiusSquared )
+                return true;
+        }
+    }
+
+    return false;
 }
 
 /**
  * @brief QGraphEdgePrivate::point
  * @param coord - the point coordinate in the Graphviz internal coordinate system
+ * @param mirrorY - the sum of the Graphviz y coordinate values mapped to each other by the Qt coordinate system
  * @return - coordinate in Qt coordinate system
  *
  * Transforms the point represented in the Graphviz internal coordinate system
  * to the Qt coordinate system.
  */
-QPointF QGraphEdgePrivate::point(const pointf& coord) const
+QPointF QGraphEdgePrivate::point(const pointf& coord, qreal mirrorY)
 {
     // return coordinate in Qt coordinate system
     // - Qt coordinate system origin is on the top-left
     // - Graphviz internal coordinate system origin is on the botton-left
-    // - thus just subtract graphviz y coordinate value from the graph height
-    return QPointF( coord.x, height() - coord.y );
+    // - thus mirror the graphviz y coordinate value
+    return QPointF( coord.x, mirrorY - coord.y );
 }
 
 /**
  * @brief QGraphEdgePrivate::path
+ * @param geometry - the edge geometry after layout
  * @return - the QPainterPath representation of the edge
  *
- * Uses the spline attribute state or the underlying libcgraph edge to return the QPainterPath representation.
+ * Uses the splines of the edge geometry to return the QPainterPath representation.
  */
-QPainterPath QGraphEdgePrivate::path() const
+QPainterPath QGraphEdgePrivate::path(const Geometry& geometry)
 {
     QPainterPath path;
 
-    // get the Cubic
-    const splines* spline = ED_spl( m_edge );
-
     // process each Cubic Bezier Spline
     // NOTE: all points are expressed in the global coordinate system
-    for( bezier* b = spline->list; b < spline->list + spline->size; b++ ) {
-        if ( b->size % 3 != 1 )
-            continue;  // Cubic Bezier Spline doesn't have the correct number of points
+    foreach( const Spline& s, geometry.splines ) {
+        const QPolygonF& points = s.points;
         // check if there is a beginning line segment
-        if ( b->sflag ) {
+        if ( s.sflag ) {
             // draw line from starting point to first point in spline
-            path.moveTo( point( b->sp ) );
-            path.lineTo( point( b->list[0] ) );
+            path.moveTo( s.sp );
+            path.lineTo( points.first() );
             // create head arrow to build the proper outline for selection highlighting
-            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( point( b->list[0] ), point( b->sp ) ) ) );
+            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( points.first(), s.sp ) ) );
         }
         else {
             // set the starting point of the spline
-            path.moveTo( point( b->list[0] ) );
+            path.moveTo( points.first() );
         }
         // add each segment of the Cubic Bezier Spline to the path
-        for ( int i=1; i<b->size; i+=3 ) {
-            path.cubicTo( point( b->list[i] ), point( b->list[i+1] ), point( b->list[i+2] ) );
+        for ( int i=1; i<points.size(); i+=3 ) {
+            path.cubicTo( points[i], points[i+1], points[i+2] );
         }
         // check if there is a ending line segment
-        if ( b->eflag ) {
+        if ( s.eflag ) {
             // draw line from the last point in the spline to the ending point
-            path.lineTo( point( b->ep ) );
+            path.lineTo( s.ep );
             // create tail arrow to build the proper outline for selection highlighting
-            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( point( b->list[b->size-1] ), point( b->ep ) ) ) );
+            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( points.last(), s.ep ) ) );
         }
     }
 
@@ -245,35 +563,31 @@ QPainterPath QGraphEdgePrivate::path() const
 
 /**
  * @brief QGraphEdgePrivate::arrowPath
+ * @param geometry - the edge geometry after layout
  * @return - the QPainterPath representation of the edge head and tail arrows
  *
- * Uses the spline attribute state or the underlying libcgraph edge to return the QPainterPath representation.
+ * Uses the splines of the edge geometry to return the QPainterPath representation.
  */
-QPainterPath QGraphEdgePrivate::arrowPath() const
+QPainterPath QGraphEdgePrivate::arrowPath(const Geometry& geometry)
 {
     QPainterPath path;
 
-    // get the Cubic
-    const splines* spline = ED_spl( m_edge );
-
     // process each Cubic Bezier Spline
     // NOTE: all points are expressed in the global coordinate system
-    for( bezier* b = spline->list; b < spline->list + spline->size; b++ ) {
-        if ( b->size % 3 != 1 )
-            continue;  // Cubic Bezier Spline doesn't have the correct number of points
+    foreach( const Spline& s, geometry.splines ) {
         // check if there is a beginning line segment
-        if ( b->sflag ) {
+        if ( s.sflag ) {
             // position path at the first point in spline
-            path.moveTo( point( b->list[0] ) );
+            path.moveTo( s.points.first() );
             // create head arrow
-            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( point( b->list[0] ), point( b->sp ) ) ) );
+            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( s.points.first(), s.sp ) ) );
         }
         // check if there is a ending line segment
-        if ( b->eflag ) {
+        if ( s.eflag ) {
             // position path at the ending point
-            path.moveTo( point( b->ep ) );
+            path.moveTo( s.ep );
             // create tail arrow
-            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( point( b->list[b->size-1] ), point( b->ep ) ) ) );
+            path.addPolygon( QGraphEdgePrivate::createNormalArrow( QLineF( s.points.last(), s.ep ) ) );
         }
     }
 
@@ -281,41 +595,36 @@ QPainterPath QGraphEdgePrivate::arrowPath() const
 }
 
 /**
- * @brief QGraphEdgePrivate::labelPath
+ * @brief QGraphEdgePrivate::labelRect
+ * @param geometry - the edge geometry after layout
  * @param fontcolor - returns the font color
  * @param fontsize - returns the font pixel size
  * @param font - returns the QFont object
- * @return - the QPainterPath representation of the edge label
+ * @return - the rectangle enclosing the edge label text
  *
- * Uses the label attribute state or the underlying libcgraph edge to return the representation in Qt.
+ * Uses the label of the edge geometry to return the rectangle in which the label text is drawn.  The rectangle is
+ * also used for hit testing the edge label.
  */
-QPainterPath QGraphEdgePrivate::labelPath(QColor& fontcolor, double& fontsize, QFont& font) const
+QRectF QGraphEdgePrivate::labelRect(const Geometry& geometry, QColor& fontcolor, double& fontsize, QFont& font)
 {
-    QPainterPath path;
+    QRectF bbox;
 
-    const textlabel_t* textlabel = ED_label( m_edge );
-
-    if ( textlabel ) {
-        // get label
-        const QString label( textlabel->text );
+    if ( geometry.hasLabel ) {
+        const QGraphNodePrivate::Label& textlabel = geometry.label;
 
         // center position of the label in node coordinates is either explicited defined in the label or set to the node origin
         // NOTE: all points are expressed in the global coordinate system
-        const QPointF labelCenter = ( textlabel->set ) ? point( textlabel->pos ) : QPointF( 0.0, 0.0 );
-
-        // get label font family and color
-        const QColor fontcolorLocal( textlabel->fontcolor );
-        QFont fontLocal( textlabel->fontname );
-        // calculate the pixel size of the font
-        const int pixelSize = std::max( textlabel->fontsize * 72.0 / m_logicalDpiY - 2, 6.0 );
-        // set pixel size by scaling point size in accordance to logical DPI Y of paint device
-        fontLocal.setPixelSize( pixelSize );
+        const QPointF labelCenter = textlabel.center;
+
+        // get label font scaling the point size in accordance to logical DPI Y of the desktop
+        const int pixelSize = std::max( textlabel.fontSize * 72.0 / geometry.logicalDpiY - 2, 6.0 );
+        const QFont fontLocal = QGraphCanvasPrivate::labelFont( textlabel.fontName, pixelSize );
         const QFontMetricsF fontMetrics( fontLocal );
 
         // get vertical alignment within label space rectangle
         int flags( Qt::AlignHCenter );  // center horizontally
         // determine vertical alignment and OR 'flags' variable with appropriate vertical alignment flag
-        switch ( textlabel->valign ) {
+        switch ( textlabel.valign ) {
         case 't': flags |= Qt::AlignTop; break;
         case 'b': flags |= Qt::AlignBottom; break;
         default: // include 'c'
@@ -323,18 +632,15 @@ QPainterPath QGraphEdgePrivate::labelPath(QColor& fontcolor, double& fontsize, Q
         }
 
         // get label space rectangle
-        const QRectF space( QPointF(0.0, 0.0), QPointF(textlabel->space.x, textlabel->space.y) );
-        QRectF bbox = fontMetrics.boundingRect( space, flags, label );
+        const QRectF space( QPointF(0.0, 0.0), textlabel.space );
+        bbox = fontMetrics.boundingRect( space, flags, textlabel.text );
         // place center of label space rectangle at specified label center coordinate
         bbox.moveCenter( labelCenter );
 
-        // return the path to render the label (needs to be positioned at the label's baseline)
-        path.addText( QPointF( bbox.x(), bbox.bottom() - fontMetrics.descent() ), fontLocal, label );
-
-        fontcolor = fontcolorLocal;
-        fontsize = textlabel->fontsize;
+        fontcolor = textlabel.fontColor;
+        fontsize = textlabel.fontSize;
         font = fontLocal;
     }
 
-    return path;
+    return bbox;
 }
@@ -27,34 +27,91 @@
 #include "QGraphEdge.h"
 #include "QGraphNode.h"
 #include "QGraphCanvas.h"
+#include "QGraphNodePrivate.h"
 
 #include "graphviz/cgraph.h"
 #include "graphviz/types.h"
 
+#include <QFont>
+#include <QPainterPath>
+#include <QStaticText>
+
+class QDataStream;
+class QPainter;
+
 class QGraphEdgePrivate
 {
     Q_DECLARE_PUBLIC(QGraphEdge)
 
+    friend class QGraphCanvasPrivate;
+    friend class QGraphViewPrivate;
+
 public:
 
     explicit QGraphEdgePrivate(const QString& name, QGraphCanvasPrivate* canvas, QGraphNodePrivate* head, QGraphNodePrivate* tail, QGraphEdge* parent = 0);
     explicit QGraphEdgePrivate(Agedge_t* edge, QGraphEdge* parent = 0);
 
+    // edge state after layout
+    struct State {
+        State() : fontSize( 0.0 ) { }
+        QPointF pos;
+        QPainterPath path;
+        QRectF labelRect;
+        QStaticText labelText;
+        QPainterPath arrowPath;
+        QList< QPolygonF > polylines;
+        QFont font;
+        QColor fontColor;
+        double fontSize;
+        QRectF boundingBox;
+    };
+
+    // cubic Bezier spline of the edge after layout with optional line segments to the starting and ending points
+    struct Spline {
+        Spline() : sflag( false ), eflag( false ) { }
+        QPolygonF points;
+        bool sflag;
+        QPointF sp;
+        bool eflag;
+        QPointF ep;
+    };
+
+    // edge layout geometry copied from the libcgraph edge after layout
+    struct Geometry {
+        Geometry() : hasLabel( false ), logicalDpiY( 96 ) { }
+        QList< Spline > splines;
+        bool hasLabel;
+        QGraphNodePrivate::Label label;
+        int logicalDpiY;
+    };
+
+    static Geometry layoutGeometry(Agedge_t* e, int logicalDpiY);
+    static Geometry layoutGeometry(Agedge_t* e, int logicalDpiY, qreal mirrorY);
+    static State layoutState(const Geometry& geometry);
+    static State layoutState(Agedge_t* e, int logicalDpiY);
+
+    static void writeState(QDataStream& stream, const State& state);
+    static void readState(QDataStream& stream, State& state);
+
+    static void paint(QPainter* painter, const State& state, const QGraphNodePrivate::PaintOptions& options, bool selected);
+
 protected:
 
     void setAttribute(const QString &name, const QString &value);
 
     void updateState();
+    void setState(const State& state);
+    State state() const;
 
 private:
 
     QRectF boundingRect() const;
-    double height() const;
-    QPointF point(const pointf& coord) const;
-    QPainterPath path() const;
-    QPainterPath arrowPath() const;
-    QPainterPath labelPath(QColor& fontcolor, double& fontsize, QFont& font) const;
-    void drawLabel(QPainter* painter) const;
+    QPainterPath selectionShape() const;
+    bool polylineContains(const QPointF& point) const;
+    static QPointF point(const pointf& coord, qreal mirrorY);
+    static QPainterPath path(const Geometry& geometry);
+    static QPainterPath arrowPath(const Geometry& geometry);
+    static QRectF labelRect(const Geometry& geometry, QColor& fontcolor, double& fontsize, QFont& font);
     static QPolygonF createNormalArrow(const QLineF &line);
 
 private:
@@ -64,18 +121,21 @@ private:
     // edge specification
     Agedge_t* m_edge;
 
-    // logical DPI Y of painter device (determined in constructor)
-    int m_logicalDpiY;
-
     // edge state after layout
     QPainterPath m_path;
-    QPainterPath m_labelPath;
+    QRectF m_labelRect;
+    QStaticText m_labelText;
     QPainterPath m_arrowPath;
+    QList< QPolygonF > m_polylines;
     QFont m_font;
     QColor m_fontColor;
     double m_fontSize;
     QRectF m_boundingBox;
 
+    // selection outline and flattened edge path computed on demand for hit testing
+    mutable QPainterPath m_selectionShape;
+    mutable QList< QPolygonF > m_hitTestPolylines;
+
 };
 
 #endif // QGRAPHEDGEPRIVATE_H
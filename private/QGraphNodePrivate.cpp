@@ -28,8 +28,10 @@
 
 #include "common/argonavis-lib-config.h"
 
+#include <QDataStream>
 #include <QFontMetricsF>
 #include <QPainter>
+#include <QStyleOptionGraphicsItem>
 #include <QDebug>
 
 
@@ -48,7 +50,7 @@ QGraphNodePrivate::QGraphNodePrivate(const QString& name, QGraphCanvasPrivate* c
 {
     m_node = agnode( canvas->graph(), name.toLocal8Bit().data(), TRUE );
 
-    setAttribute( QStringLiteral("label"), name.toLocal8Bit().data() );
+    QGraphCanvasPrivate::setAttributeValue( m_node, canvas->attributeSymbol( AGNODE, QStringLiteral("label"), true ), name.toLocal8Bit() );
 }
 
 /**
@@ -87,8 +89,16 @@ Agnode_t* QGraphNodePrivate::node() const
  */
 void QGraphNodePrivate::setAttribute(const QString &name, const QString &value)
 {
-    const QString nullstr;
-    agsafeset( m_node, name.toLocal8Bit().data(), value.toLocal8Bit().data(), nullstr.toLocal8Bit().data() );
+    Q_Q(QGraphNode);
+
+    // use the attribute symbols cached by the canvas when the node has been added to one
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( q->scene() );
+
+    Agsym_t* symbol = ( canvas && canvas->d_func()->graph() == agroot( m_node ) )
+            ? canvas->d_func()->attributeSymbol( AGNODE, name, true )
+            : QGraphCanvasPrivate::attributeSymbol( agraphof( m_node ), AGNODE, name.toLocal8Bit(), true );
+
+    QGraphCanvasPrivate::setAttributeValue( m_node, symbol, value.toLocal8Bit() );
 }
 
 /**
@@ -100,7 +110,20 @@ void QGraphNodePrivate::setAttribute(const QString &name, const QString &value)
  */
 QVariant QGraphNodePrivate::attribute(const QString &name) const
 {
-    return QVariant( agget( m_node, name.toLocal8Bit().data() ) );
+    return attribute( m_node, name );
+}
+
+/**
+ * @brief QGraphNodePrivate::attribute
+ * @param n - the libcgraph node instance
+ * @param name - the name of the attribute
+ * @return - the attribute value
+ *
+ * Gets the value of the named attribute of the specified libcgraph node.
+ */
+QVariant QGraphNodePrivate::attribute(Agnode_t* n, const QString &name)
+{
+    return QVariant( QGraphCanvasPrivate::attributeValue( n, QGraphCanvasPrivate::attributeSymbol( agraphof( n ), AGNODE, name.toLocal8Bit(), false ) ) );
 }
 
 /**
@@ -110,29 +133,154 @@ QVariant QGraphNodePrivate::attribute(const QString &name) const
  */
 void QGraphNodePrivate::updateState()
 {
-    Q_Q(QGraphNode);
-    q->setPos( point( ND_coord( m_node ) ) );
+    setState( layoutState( m_node, QGraphCanvasPrivate::logicalDpiY() ) );
+}
+
+/**
+ * @brief QGraphNodePrivate::updatePaintState
+ *
+ * Updates only the styles and colors of the node from its current attributes.  The geometry of the node is unchanged, so
+ * neither a layout nor QGraphicsItem::prepareGeometryChange() is required, and the node is not repainted by this method.
+ */
+void QGraphNodePrivate::updatePaintState()
+{
+    Geometry geometry;
+    paintAttributes( m_node, geometry );
+
+    State state;
+    layoutPaintState( geometry, state );
+
+    m_styles = state.styles;
+    m_penColor = state.penColor;
+    m_fillColor = state.fillColor;
+}
+
+/**
+ * @brief QGraphNodePrivate::layoutGeometry
+ * @param n - the libcgraph node instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the label font
+ * @return - the node geometry after layout
+ *
+ * Copies the position, shape vertices, label and the attributes determining the appearance of the libcgraph node.
+ * The libcgraph attribute lookups are not thread-safe, so this method must be serialized with all other libcgraph accesses.
+ */
+QGraphNodePrivate::Geometry QGraphNodePrivate::layoutGeometry(Agnode_t* n, int logicalDpiY)
+{
+    // mirror the Graphviz y coordinate values within the graph bounding box (the lower-left corner of the bounding
+    // box is the origin unless the layout engine has been told not to translate the drawing)
+    const boxf bb = GD_bb( agraphof( n ) );
+
+    return layoutGeometry( n, logicalDpiY, bb.LL.y + bb.UR.y );
+}
+
+/**
+ * @brief QGraphNodePrivate::layoutGeometry
+ * @param n - the libcgraph node instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the label font
+ * @param mirrorY - the sum of the Graphviz y coordinate values mapped to each other by the Qt coordinate system
+ * @return - the node geometry after layout
+ *
+ * Copies the node geometry as above but mirrors the Graphviz y coordinate values about the given value instead of
+ * the bounding box of the graph, which places the node in the coordinate system of another layout.
+ */
+QGraphNodePrivate::Geometry QGraphNodePrivate::layoutGeometry(Agnode_t* n, int logicalDpiY, qreal mirrorY)
+{
+    Geometry geometry;
+
+    geometry.logicalDpiY = logicalDpiY;
+
+    geometry.pos = point( ND_coord( n ), mirrorY );
+
+    paintAttributes( n, geometry );
+
+    const shape_desc* desc = ND_shape( n );
+
+    if ( desc ) {
+        geometry.shape = QString( desc->name );
+        geometry.shapeType = shapeType( geometry.shape );
+
+        // vertix coordinates are relative to the node center
+        const polygon_t* poly = (polygon_t*)ND_shape_info( n );
+        if ( poly && ( PolygonShape == geometry.shapeType || EllipseShape == geometry.shapeType ) ) {
+            geometry.polygons = polygon( poly );
+        }
+    }
+
+    geometry.label = label( n, mirrorY );
+
+    return geometry;
+}
+
+/**
+ * @brief QGraphNodePrivate::layoutState
+ * @param geometry - the node geometry after layout
+ * @return - the node state after layout
+ *
+ * Computes the node state (position, styles, colors, painter path and label) from the node geometry.
+ * This method does not access libcgraph and thus may be invoked concurrently from worker threads.
+ */
+QGraphNodePrivate::State QGraphNodePrivate::layoutState(const Geometry& geometry)
+{
+    State state;
+
+    state.pos = geometry.pos;
+
+    layoutPaintState( geometry, state );
+
+    state.path = path( geometry );
+
+    state.boundingBox = state.path.boundingRect();
+
+    state.label = geometry.label;
+
+    layoutLabel( state.label, geometry.logicalDpiY, state.labelFont, state.labelRect, state.labelText );
 
+    return state;
+}
+
+/**
+ * @brief QGraphNodePrivate::paintAttributes
+ * @param n - the libcgraph node instance
+ * @param geometry - returns the attributes determining the appearance of the node
+ *
+ * Copies the "color", "fillcolor" and "style" attributes of the libcgraph node using the attribute symbols cached for its graph.
+ */
+void QGraphNodePrivate::paintAttributes(Agnode_t *n, Geometry &geometry)
+{
+    Agraph_t* graph = agraphof( n );
+
+    geometry.color = QGraphCanvasPrivate::attributeValue( n, QGraphCanvasPrivate::attributeSymbol( graph, QGraphCanvasPrivate::NodeColorSymbol ) );
+    geometry.fillColor = QGraphCanvasPrivate::attributeValue( n, QGraphCanvasPrivate::attributeSymbol( graph, QGraphCanvasPrivate::NodeFillColorSymbol ) );
+    geometry.style = QGraphCanvasPrivate::attributeValue( n, QGraphCanvasPrivate::attributeSymbol( graph, QGraphCanvasPrivate::NodeStyleSymbol ) );
+}
+
+/**
+ * @brief QGraphNodePrivate::layoutPaintState
+ * @param geometry - the node geometry
+ * @param state - returns the styles and colors of the node
+ *
+ * Computes the styles, pen color and fill color of the node state from the node attributes.  These only affect how the node
+ * is painted, not its geometry.
+ */
+void QGraphNodePrivate::layoutPaintState(const Geometry &geometry, State &state)
+{
     // initialize default fill color
-    QString fillColorStr = attribute("color").toString();
-    if ( ! fillColorStr.isEmpty() ) {
-        m_penColor = QColor( fillColorStr.toLocal8Bit().data() );
+    if ( ! geometry.color.isEmpty() ) {
+        state.penColor = QColor( geometry.color.toLocal8Bit().data() );
     }
 
-    m_styles = style( attribute("style").toString() );
+    state.styles = style( geometry.style );
 
-    foreach( Styles style, m_styles ) {
+    foreach( Styles style, state.styles ) {
         switch( style ) {
         case Filled: {
-            QString fillColorStr = attribute("fillcolor").toString();
-            if ( fillColorStr.isEmpty() ) {
-                const QString colorStr = attribute("color").toString();
-                if ( ! colorStr.isEmpty() ) {
-                    m_fillColor = QColor( colorStr.toLocal8Bit().data() );
+            if ( geometry.fillColor.isEmpty() ) {
+                if ( ! geometry.color.isEmpty() ) {
+                    state.fillColor = QColor( geometry.color.toLocal8Bit().data() );
                 }
             }
             else {
-                m_fillColor = QColor( fillColorStr.toLocal8Bit().data() );
+                state.fillColor = QColor( geometry.fillColor.toLocal8Bit().data() );
             }
             break;
         }
@@ -140,10 +288,120 @@ void QGraphNodePrivate::updateState()
             break;
         }
     }
+}
+
+/**
+ * @brief QGraphNodePrivate::layoutState
+ * @param n - the libcgraph node instance of a graph that has been laid out
+ * @param logicalDpiY - the logical DPI Y used to scale the label font
+ * @return - the node state after layout
+ *
+ * Computes the node state from the layout of the libcgraph node.
+ */
+QGraphNodePrivate::State QGraphNodePrivate::layoutState(Agnode_t* n, int logicalDpiY)
+{
+    return layoutState( layoutGeometry( n, logicalDpiY ) );
+}
+
+/**
+ * @brief QGraphNodePrivate::setState
+ * @param state - the node state after layout
+ *
+ * Applies the node state computed by layoutState() to the QGraphNode instance.  The caller is
+ * responsible for invoking QGraphicsItem::prepareGeometryChange() beforehand.
+ */
+void QGraphNodePrivate::setState(const State &state)
+{
+    Q_Q(QGraphNode);
+    q->setPos( state.pos );
+
+    m_penColor = state.penColor;
+    m_fillColor = state.fillColor;
+    m_styles = state.styles;
+    m_path = state.path;
+    m_boundingBox = state.boundingBox;
+    m_label = state.label;
+    m_labelFont = state.labelFont;
+    m_labelRect = state.labelRect;
+    m_labelText = state.labelText;
+}
+
+/**
+ * @brief QGraphNodePrivate::state
+ * @return - the current node state
+ *
+ * Returns the node state last applied by setState().
+ */
+QGraphNodePrivate::State QGraphNodePrivate::state() const
+{
+    Q_Q(const QGraphNode);
+
+    State state;
 
-    m_path = path( m_node );
+    state.pos = q->pos();
+    state.styles = m_styles;
+    state.fillColor = m_fillColor;
+    state.penColor = m_penColor;
+    state.path = m_path;
+    state.boundingBox = m_boundingBox;
+    state.label = m_label;
+    state.labelFont = m_labelFont;
+    state.labelRect = m_labelRect;
+    state.labelText = m_labelText;
 
-    m_boundingBox = m_path.boundingRect();
+    return state;
+}
+
+/**
+ * @brief QGraphNodePrivate::writeState
+ * @param stream - the data stream
+ * @param state - the node state
+ *
+ * Writes the node state to the data stream.
+ */
+void QGraphNodePrivate::writeState(QDataStream &stream, const State &state)
+{
+    QList< qint32 > styles;
+    foreach ( Styles style, state.styles ) {
+        styles << style;
+    }
+
+    stream << state.pos << styles << state.fillColor << state.penColor << state.path << state.boundingBox;
+    stream << state.label.text << state.label.center << state.label.fontName << state.label.fontSize
+           << state.label.fontColor << qint8( state.label.valign ) << state.label.space;
+    stream << state.labelFont << state.labelRect;
+}
+
+/**
+ * @brief QGraphNodePrivate::readState
+ * @param stream - the data stream
+ * @param state - returns the node state
+ *
+ * Reads the node state written by writeState() from the data stream.  The label text is laid out as done by layoutLabel().
+ */
+void QGraphNodePrivate::readState(QDataStream &stream, State &state)
+{
+    QList< qint32 > styles;
+    qint8 valign( 'c' );
+
+    stream >> state.pos >> styles >> state.fillColor >> state.penColor >> state.path >> state.boundingBox;
+    stream >> state.label.text >> state.label.center >> state.label.fontName >> state.label.fontSize
+           >> state.label.fontColor >> valign >> state.label.space;
+    stream >> state.labelFont >> state.labelRect;
+
+    state.styles.clear();
+    foreach ( qint32 style, styles ) {
+        state.styles.insert( static_cast< Styles >( style ) );
+    }
+
+    state.label.valign = valign;
+
+    if ( ! state.label.text.isEmpty() ) {
+        state.labelText.setText( state.label.text );
+        state.labelText.setTextFormat( Qt::PlainText );
+        state.labelText.setTextWidth( state.labelRect.width() );
+        state.labelText.setTextOption( QTextOption( Qt::AlignHCenter ) );
+    }
 }
 
 /**
@@ -155,29 +413,26 @@ void QGraphNodePrivate::updateState()
  */
 QRectF QGraphNodePrivate::boundingRect() const
 {
-    Q_Q(const QGraphNode);
-
-    if ( q->isSelected() )
-        return m_boundingBox.adjusted( -1.0, -1.0, 1.0, 1.0 );
-    else
-        return m_boundingBox;
+    // include the wider selection pen so that selecting the node does not change its geometry
+    return m_boundingBox.adjusted( -1.0, -1.0, 1.0, 1.0 );
 }
 
 /**
- * @brief QGraphEdgePrivate::point
+ * @brief QGraphNodePrivate::point
  * @param coord - the point coordinate in the Graphviz internal coordinate system
+ * @param mirrorY - the sum of the Graphviz y coordinate values mapped to each other by the Qt coordinate system
  * @return - coordinate in Qt coordinate system
  *
  * Transforms the point represented in the Graphviz internal coordinate system
  * to the Qt coordinate system.
  */
-QPointF QGraphNodePrivate::point(const pointf& coord) const
+QPointF QGraphNodePrivate::point(const pointf& coord, qreal mirrorY)
 {
     // return coordinate in Qt coordinate system
     // - Qt coordinate system origin is on the top-left
     // - Graphviz internal coordinate system origin is on the botton-left
-    // - thus just subtract graphviz y coordinate value from the graph height
-    return QPointF( coord.x, height() - coord.y );
+    // - thus mirror the graphviz y coordinate value
+    return QPointF( coord.x, mirrorY - coord.y );
 }
 
 /**
@@ -188,7 +443,7 @@ QPointF QGraphNodePrivate::point(const pointf& coord) const
  * Parses a comma-delimited string of edge line styles and returns a set of
  * internal style enums.
  */
-QSet<QGraphNodePrivate::Styles> QGraphNodePrivate::style(const QString &str) const
+QSet<QGraphNodePrivate::Styles> QGraphNodePrivate::style(const QString &str)
 {
     QSet<QGraphNodePrivate::Styles> styles;
 
@@ -216,19 +471,6 @@ QSet<QGraphNodePrivate::Styles> QGraphNodePrivate::style(const QString &str) con
     return styles;
 }
 
-/**
- * @brief QGraphEdgePrivate::height
- * @return - the height of the node bounding box
- *
- * Returns the height of the node bounding box.
- */
-double QGraphNodePrivate::height() const
-{
-    const boxf bb = GD_bb( agraphof( m_node ) );
-
-    return ( bb.UR.y - bb.LL.y );
-}
-
 /**
  * @brief QGraphNodePrivate::polygon
  * @param poly - a pointer to the Graphviz polygon instance
@@ -237,7 +479,7 @@ double QGraphNodePrivate::height() const
  *
  * Parses the Graphviz polygon instance and builds multiple QPolygonF instances returned as a QList.
  */
-QList< QPolygonF > QGraphNodePrivate::polygon(const polygon_t *poly, const bool close) const
+QList< QPolygonF > QGraphNodePrivate::polygon(const polygon_t *poly, const bool close)
 {
     QList< QPolygonF > polygons;
 
@@ -266,110 +508,230 @@ QList< QPolygonF > QGraphNodePrivate::polygon(const polygon_t *poly, const bool
 }
 
 /**
- * @brief QGraphNodePrivate::path
- * @param n - the libcgraph node instance
- * @return - returns a QPainterPath representation of the node shape
+ * @brief QGraphNodePrivate::shapeType
+ * @param shape - the Graphviz node shape name
+ * @return - the type of geometry representing the node shape
  *
- * Constructs and returns a QPainterPath representation of the node shape.
+ * Classifies the node shape by the type of geometry that can be added to a QPainterPath (polygon and ellipse).
  */
-QPainterPath QGraphNodePrivate::path(Agnode_t* n) const
+QGraphNodePrivate::ShapeTypes QGraphNodePrivate::shapeType(const QString &shape)
 {
     // define list of supported shapes for the types of geometry that can be added to a QPainterPath (polygon and ellipse)
 #if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
     static QStringList SHAPE_POLYGONS_TYPES{ "rectangle", "box", "square", "polygon", "diamond", "star", "rect", "triangle", "diamond",
                                              "trapezium", "parallelogram", "house", "pentagon", "hexagon", "septagon", "octagon", "doubleoctagon",
-                                             "tripleoctagon", "invtriangle", "invtrapezium", "invhouse", "Mdiamond", "Msquare", "note"
+                                             "tripleoctagon", "invtriangle", "invtrapezium", "invhouse", "Mdiamond", "Msquare", "note",
+                                             "plaintext", "plain", "none"
                                            };
-    static QStringList SHAPE_ELLIPSE_TYPES{ "ellipse", "circle", "oval",  };
+    static QStringList SHAPE_ELLIPSE_TYPES{ "ellipse", "circle", "oval", "doublecircle", "point" };
     static QStringList SHAPE_RECORD_TYPES{ "record", "Mrecord" };
 #else
     static QStringList SHAPE_POLYGONS_TYPES = QStringList() << "rectangle" << "box" << "square" << "polygon" << "diamond" << "star" << "rect" << "triangle" << "diamond"
                                                             << "trapezium" << "parallelogram" << "house" << "pentagon" << "hexagon" << "septagon" << "octagon" << "doubleoctagon"
-                                                               "tripleoctagon" <<"invtriangle" << "invtrapezium" << "invhouse" << "Mdiamond" << "Msquare" << "note";
-    static QStringList SHAPE_ELLIPSE_TYPES = QStringList() << "ellipse" << "circle" << "oval";
+                                                               "tripleoctagon" <<"invtriangle" << "invtrapezium" << "invhouse" << "Mdiamond" << "Msquare" << "note"
+                                                            << "plaintext" << "plain" << "none";
+    static QStringList SHAPE_ELLIPSE_TYPES = QStringList() << "ellipse" << "circle" << "oval" << "doublecircle" << "point";
     static QStringList SHAPE_RECORD_TYPES = QStringList() << "record" << "Mrecord";
 #endif
 
-    QPainterPath path;
-
-    const shape_desc* desc = ND_shape( n );
-
-    const QString shapeType( desc->name );
-
-    if ( SHAPE_POLYGONS_TYPES.contains( shapeType ) ) {
-        const polygon_t* poly = (polygon_t*)ND_shape_info( n );
+    if ( SHAPE_POLYGONS_TYPES.contains( shape ) )
+        return PolygonShape;
+    else if ( SHAPE_ELLIPSE_TYPES.contains( shape ) )
+        return EllipseShape;
+    else if ( SHAPE_RECORD_TYPES.contains( shape ) )
+        return RecordShape;
+    else
+        return UnsupportedShape;
+}
 
-        QList< QPolygonF > polys = polygon( poly, true );
+/**
+ * @brief QGraphNodePrivate::path
+ * @param geometry - the node geometry after layout
+ * @return - returns a QPainterPath representation of the node shape
+ *
+ * Constructs and returns a QPainterPath representation of the node shape.
+ */
+QPainterPath QGraphNodePrivate::path(const Geometry& geometry)
+{
+    QPainterPath path;
 
-        foreach( const QPolygonF poly, polys ) {
+    if ( PolygonShape == geometry.shapeType ) {
+        foreach( QPolygonF poly, geometry.polygons ) {
+            // make this a closed polygon
+            if ( ! poly.isEmpty() )
+                poly.append( poly.first() );
             path.addPolygon( poly );
         }
     }
-    else if ( SHAPE_ELLIPSE_TYPES.contains( shapeType ) ) {
-        const polygon_t* poly = (polygon_t*)ND_shape_info( n );
-        QList< QPolygonF > polys = polygon( poly, true );
-        if ( polys.size() > 0 ) {
-            const QPolygonF ellipseBoundingRect = polygon( poly ).front();
+    else if ( EllipseShape == geometry.shapeType ) {
+        if ( geometry.polygons.size() > 0 ) {
+            const QPolygonF ellipseBoundingRect = geometry.polygons.front();
             if ( 2 == ellipseBoundingRect.size() ) {
                 path.addEllipse( QRectF( ellipseBoundingRect.first(), ellipseBoundingRect.last() ) );
             }
         }
     }
-#if 0
-    else if ( SHAPE_RECORD_TYPES.contains( shapeType ) ) {
-        const field_t* fields = (field_t*)ND_shape_info( n );
-    }
-#endif
     else {
-        qWarning() << "UNSUPPORTED: shape type: " << shapeType;
+        qWarning() << "UNSUPPORTED: shape type: " << geometry.shape;
     }
 
     return path;
 }
 
 /**
- * @brief QGraphNodePrivate::drawLabel
- * @param painter - the scene painter instance to be used for drawing the background
+ * @brief QGraphNodePrivate::label
+ * @param n - the libcgraph node instance
+ * @param mirrorY - the sum of the Graphviz y coordinate values mapped to each other by the Qt coordinate system
+ * @return - the node label specification after layout
  *
- * Helper method to render the label for the node on the scene canvas.
+ * Copies the label text, position, font and alignment of the libcgraph node so that the label
+ * can be rendered without accessing the layout of the libcgraph node.
  */
-void QGraphNodePrivate::drawLabel(QPainter* painter) const
+QGraphNodePrivate::Label QGraphNodePrivate::label(Agnode_t* n, qreal mirrorY)
 {
-    const textlabel_t* textlabel = ND_label( m_node );
+    Label label;
 
-    if ( textlabel ) {
-        // get label
-        const QString label( textlabel->text );
+    const textlabel_t* textlabel = ND_label( n );
 
+    if ( textlabel ) {
+        label.text = QString( textlabel->text );
         // center position of the label in node coordinates is either explicited defined in the label or set to the node origin
-        const QPointF labelCenter = ( textlabel->set ) ? point( textlabel->pos ) : QPointF( 0.0, 0.0 );
-
-        // get label font family and color
-        const QColor fontcolor( textlabel->fontcolor );
-        QFont font( textlabel->fontname );
-        // set pixel size by scaling point size in accordance to logical DPI Y of paint device
-        font.setPixelSize( textlabel->fontsize * 72.0 / painter->device()->logicalDpiY() );
-        const QFontMetricsF fontMetrics( font );
-
-        // get vertical alignment within label space rectangle
-        int flags( Qt::AlignHCenter );  // center horizontally
-        // determine vertical alignment and OR 'flags' variable with appropriate vertical alignment flag
-        switch ( textlabel->valign ) {
-        case 't': flags |= Qt::AlignTop; break;
-        case 'b': flags |= Qt::AlignBottom; break;
-        default: // include 'c'
-            flags |= Qt::AlignVCenter; break;
-        }
+        label.center = ( textlabel->set ) ? point( textlabel->pos, mirrorY ) : QPointF( 0.0, 0.0 );
+        label.fontName = QString( textlabel->fontname );
+        label.fontSize = textlabel->fontsize;
+        label.fontColor = QColor( textlabel->fontcolor );
+        label.valign = textlabel->valign;
+        label.space = QSizeF( textlabel->space.x, textlabel->space.y );
+    }
+
+    return label;
+}
 
-        // get label space rectangle
-        const QRectF space( QPointF(0.0, 0.0), QPointF(textlabel->space.x, textlabel->space.y) );
-        QRectF bbox = fontMetrics.boundingRect( space, flags, label );
-        // place center of label space rectangle at specified label center coordinate
-        bbox.moveCenter( labelCenter );
+/**
+ * @brief QGraphNodePrivate::layoutLabel
+ * @param label - the node label specification after layout
+ * @param logicalDpiY - the logical DPI Y used to scale the label font
+ * @param font - returns the label font
+ * @param rect - returns the rectangle in node coordinates in which the label text is drawn
+ * @param text - returns the label text to be drawn
+ *
+ * Lays out the label once after layout so that drawing the label does no font lookup or text measurement.
+ * This method does not access libcgraph and thus may be invoked concurrently from worker threads.
+ */
+void QGraphNodePrivate::layoutLabel(const Label &label, int logicalDpiY, QFont &font, QRectF &rect, QStaticText &text)
+{
+    if ( label.text.isEmpty() )
+        return;
+
+    // get label font scaling the point size in accordance to logical DPI Y of the desktop
+    font = QGraphCanvasPrivate::labelFont( label.fontName, label.fontSize * 72.0 / logicalDpiY );
+    const QFontMetricsF fontMetrics( font );
+
+    // get vertical alignment within label space rectangle
+    int flags( Qt::AlignHCenter );  // center horizontally
+    // determine vertical alignment and OR 'flags' variable with appropriate vertical alignment flag
+    switch ( label.valign ) {
+    case 't': flags |= Qt::AlignTop; break;
+    case 'b': flags |= Qt::AlignBottom; break;
+    default: // include 'c'
+        flags |= Qt::AlignVCenter; break;
+    }
+
+    // get label space rectangle
+    const QRectF space( QPointF(0.0, 0.0), label.space );
+    rect = fontMetrics.boundingRect( space, flags, label.text );
+    // place center of label space rectangle at specified label center coordinate
+    rect.moveCenter( label.center );
+
+    // center each line of the label horizontally within the label rectangle
+    text.setText( label.text );
+    text.setTextFormat( Qt::PlainText );
+    text.setTextWidth( rect.width() );
+    text.setTextOption( QTextOption( Qt::AlignHCenter ) );
+}
 
+/**
+ * @brief QGraphNodePrivate::drawLabel
+ * @param painter - the painter instance to be used for drawing the label
+ * @param state - the node state
+ *
+ * Helper method to render the label for the node.  The label has been laid out by layoutLabel().
+ */
+void QGraphNodePrivate::drawLabel(QPainter* painter, const State& state)
+{
+    if ( ! state.labelText.text().isEmpty() ) {
         // set the drawing pen and draw the label
-        painter->setPen( fontcolor );
-        painter->setFont( font );
-        painter->drawText( bbox, flags, label );
+        painter->setPen( state.label.fontColor );
+        painter->setFont( state.labelFont );
+        painter->drawStaticText( state.labelRect.topLeft(), state.labelText );
     }
 }
+
+/**
+ * @brief QGraphNodePrivate::paintOptions
+ * @param scene - the scene in which the node or edge resides
+ * @return - the level of detail thresholds and selection color of the canvas
+ *
+ * Returns the paint options of the canvas or the default paint options if the scene is not a QGraphCanvas instance.
+ */
+QGraphNodePrivate::PaintOptions QGraphNodePrivate::paintOptions(QGraphicsScene *scene)
+{
+    PaintOptions options;
+
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( scene );
+    if ( canvas ) {
+        options.labelThreshold = canvas->labelLevelOfDetailThreshold();
+        options.shapeThreshold = canvas->shapeLevelOfDetailThreshold();
+        options.selectionColor = canvas->selectionColor();
+    }
+
+    return options;
+}
+
+/**
+ * @brief QGraphNodePrivate::paint
+ * @param painter - the painter instance to be used for drawing the node in node coordinates
+ * @param state - the node state
+ * @param options - the level of detail thresholds and selection color
+ * @param selected - whether the node is drawn as selected
+ *
+ * Draws the node from its state.  Below the level of detail thresholds the label is skipped and the node is drawn
+ * as a filled rectangle.  This method does not access the QGraphNode instance and thus may be invoked from worker
+ * threads painting on a QImage provided the label text of the state is not shared with the GUI thread.
+ */
+void QGraphNodePrivate::paint(QPainter *painter, const State &state, const PaintOptions &options, bool selected)
+{
+    if ( state.styles.contains( Invisible ) )
+         return;
+
+    // determine the level of detail from the scale of the painter transform
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform( painter->worldTransform() );
+
+    if ( lod < options.shapeThreshold ) {
+        // fill the bounding rectangle with the selection color, the fill color or the pen color for unfilled nodes
+        if ( selected )
+            painter->fillRect( state.boundingBox, options.selectionColor );
+        else
+            painter->fillRect( state.boundingBox, ( state.fillColor.alpha() > 0 ) ? state.fillColor : state.penColor );
+        return;
+    }
+
+    painter->save();
+
+    painter->setBrush( state.fillColor );
+
+    // highlight selected nodes by outlining them with a wider pen of the selection color
+    if ( selected )
+        painter->setPen( QPen( options.selectionColor, 2.0 ) );
+    else
+        painter->setPen ( state.penColor );
+
+    painter->drawPath( state.path );
+
+    // for now not rendered as painter path generated in updateState() but may have to change if
+    // node labels can extend outside the node bounding rectangle
+    if ( lod >= options.labelThreshold )
+        drawLabel( painter, state );
+
+    painter->restore();
+}
@@ -30,19 +30,94 @@
 #include "graphviz/cgraph.h"
 #include "graphviz/types.h"
 
+#include <QFont>
 #include <QSet>
+#include <QPainterPath>
+#include <QStaticText>
+
+class QDataStream;
+class QGraphicsScene;
+class QPainter;
 
 class QGraphNodePrivate
 {
     Q_DECLARE_PUBLIC(QGraphNode)
 
     friend class QGraphEdgePrivate;
+    friend class QGraphCanvasPrivate;
+    friend class QGraphViewPrivate;
 
 public:
 
     explicit QGraphNodePrivate(const QString& name, QGraphCanvasPrivate* canvas, QGraphNode* parent = 0);
     explicit QGraphNodePrivate(Agnode_t* node, QGraphNode* parent = 0);
 
+    enum Styles { Default, Filled, Invisible, Diagonals, Rounded, Dashed, Dotted, Solid, Bold };
+
+    enum ShapeTypes { UnsupportedShape, PolygonShape, EllipseShape, RecordShape };
+
+    // node label specification after layout
+    struct Label {
+        Label() : fontSize( 0.0 ), valign( 'c' ) { }
+        QString text;
+        QPointF center;
+        QString fontName;
+        double fontSize;
+        QColor fontColor;
+        char valign;
+        QSizeF space;
+    };
+
+    // node state after layout
+    struct State {
+        State() : fillColor( Qt::transparent ), penColor( Qt::black ) { }
+        QPointF pos;
+        QSet< Styles > styles;
+        QColor fillColor;
+        QColor penColor;
+        QPainterPath path;
+        QRectF boundingBox;
+        Label label;
+        QFont labelFont;
+        QRectF labelRect;
+        QStaticText labelText;
+    };
+
+    // node layout geometry and attributes copied from the libcgraph node after layout
+    struct Geometry {
+        Geometry() : shapeType( UnsupportedShape ), logicalDpiY( 96 ) { }
+        QPointF pos;
+        QString color;
+        QString fillColor;
+        QString style;
+        QString shape;
+        ShapeTypes shapeType;
+        QList< QPolygonF > polygons;
+        Label label;
+        int logicalDpiY;
+    };
+
+    // level of detail thresholds and selection color of the canvas used when painting nodes and edges
+    struct PaintOptions {
+        PaintOptions() : labelThreshold( 0.0 ), shapeThreshold( 0.0 ), selectionColor( 0, 0, 192 ) { }
+        qreal labelThreshold;
+        qreal shapeThreshold;
+        QColor selectionColor;
+    };
+
+    static Geometry layoutGeometry(Agnode_t* n, int logicalDpiY);
+    static Geometry layoutGeometry(Agnode_t* n, int logicalDpiY, qreal mirrorY);
+    static State layoutState(const Geometry& geometry);
+    static State layoutState(Agnode_t* n, int logicalDpiY);
+    static void paintAttributes(Agnode_t* n, Geometry& geometry);
+    static void layoutPaintState(const Geometry& geometry, State& state);
+
+    static void writeState(QDataStream& stream, const State& state);
+    static void readState(QDataStream& stream, State& state);
+
+    static PaintOptions paintOptions(QGraphicsScene* scene);
+    static void paint(QPainter* painter, const State& state, const PaintOptions& options, bool selected);
+
 private:
 
     Agnode_t* node() const;
@@ -50,17 +125,21 @@ private:
     QRectF boundingRect() const;
 
     void updateState();
-
-    enum Styles { Default, Filled, Invisible, Diagonals, Rounded, Dashed, Dotted, Solid, Bold };
+    void updatePaintState();
+    void setState(const State& state);
+    State state() const;
 
     void setAttribute(const QString &name, const QString &value);
     QVariant attribute(const QString &name) const;
-    QPointF point(const pointf& coord) const;
-    QSet< Styles > style(const QString& str) const;
-    double height() const;
-    QList<QPolygonF> polygon(const polygon_t *poly, const bool close = false) const;
-    QPainterPath path(Agnode_t* n) const;
-    void drawLabel(QPainter* painter) const;
+    static QVariant attribute(Agnode_t* n, const QString &name);
+    static QPointF point(const pointf& coord, qreal mirrorY);
+    static QSet< Styles > style(const QString& str);
+    static QList<QPolygonF> polygon(const polygon_t *poly, const bool close = false);
+    static ShapeTypes shapeType(const QString& shape);
+    static QPainterPath path(const Geometry& geometry);
+    static Label label(Agnode_t* n, qreal mirrorY);
+    static void layoutLabel(const Label& label, int logicalDpiY, QFont& font, QRectF& rect, QStaticText& text);
+    static void drawLabel(QPainter* painter, const State& state);
 
 private:
 
@@ -75,6 +154,10 @@ private:
     QColor m_penColor;
     QPainterPath m_path;
     QRectF m_boundingBox;
+    Label m_label;
+    QFont m_labelFont;
+    QRectF m_labelRect;
+    QStaticText m_labelText;
 
 };
 
@@ -0,0 +1,646 @@
+/*!
+   \file QGraphViewPrivate.cpp
+   \author Gregory Schultz <gregory.schultz@embarqmail.com>
+
+   \section LICENSE
+   This file is part of the Open|SpeedShop Graphical User Interface
+   Copyright (C) 2010-2017 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include "QGraphViewPrivate.h"
+
+#include "QGraphCanvas.h"
+#include "QGraphNode.h"
+#include "QGraphEdge.h"
+
+#include <QGraphicsScene>
+#include <QtConcurrentRun>
+#include <QTimer>
+#include <QDebug>
+
+#include <cmath>
+
+// width and height of the rasterized tiles in device pixels
+static const int TILE_SIZE = 256;
+
+// number of zoom levels per doubling of the view scale for which tiles are rasterized
+static const int LEVELS_PER_OCTAVE = 4;
+
+// default maximum size of the cached tile images in kilobytes
+static const int TILE_CACHE_LIMIT = 64 * 1024;
+
+// default limits of the view scale
+static const qreal MINIMUM_ZOOM = 0.05;
+static const qreal MAXIMUM_ZOOM = 10.0;
+
+// time in milliseconds without scrolling or zooming after which antialiasing is re-enabled
+static const int SCROLL_IDLE_INTERVAL = 150;
+
+
+/**
+ * @brief intersects
+ * @param rect - the scene rectangle
+ * @param region - the changed scene rectangles (empty if the whole scene changed)
+ * @return - whether the scene rectangle intersects the changed region
+ */
+static bool intersects(const QRectF& rect, const QList<QRectF>& region)
+{
+    if ( region.isEmpty() )
+        return true;
+
+    foreach ( const QRectF& changedRect, region ) {
+        if ( rect.intersects( changedRect ) )
+            return true;
+    }
+
+    return false;
+}
+
+/**
+ * @brief QGraphViewPrivate::QGraphViewPrivate
+ * @param parent - the QGraphView instance
+ *
+ * Constructs a QGraphViewPrivate instance with tiled rendering disabled and applies the default view settings for
+ * large graphs.
+ */
+QGraphViewPrivate::QGraphViewPrivate(QGraphView *parent)
+    : q_ptr( parent )
+    , m_tiledRendering( false )
+    , m_tiles( TILE_CACHE_LIMIT )
+    , m_tileSerial( 0 )
+    , m_minimumZoom( MINIMUM_ZOOM )
+    , m_maximumZoom( MAXIMUM_ZOOM )
+    , m_fastScrolling( true )
+    , m_scrolling( false )
+    , m_idleRenderHints( parent->renderHints() )
+    , m_idleTimer( new QTimer( parent ) )
+{
+    Q_Q(QGraphView);
+
+    // repaint the bounding rectangle of the changed items instead of tracking each exposed item rectangle
+    q->setViewportUpdateMode( QGraphicsView::BoundingRectViewportUpdate );
+    // the nodes and edges restore the painter state themselves and their bounding rectangles include the pen width
+    q->setOptimizationFlags( QGraphicsView::DontSavePainterState | QGraphicsView::DontAdjustForAntialiasing );
+    q->setCacheMode( QGraphicsView::CacheBackground );
+    q->setTransformationAnchor( QGraphicsView::AnchorUnderMouse );
+    q->setResizeAnchor( QGraphicsView::AnchorViewCenter );
+
+    m_idleTimer->setSingleShot( true );
+    m_idleTimer->setInterval( SCROLL_IDLE_INTERVAL );
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    QObject::connect( m_idleTimer, &QTimer::timeout, q, &QGraphView::handleScrollingFinished );
+#else
+    QObject::connect( m_idleTimer, SIGNAL(timeout()), q, SLOT(handleScrollingFinished()) );
+#endif
+}
+
+/**
+ * @brief QGraphViewPrivate::~QGraphViewPrivate
+ *
+ * Destroys the QGraphViewPrivate instance.  Tiles still being rendered are discarded when the worker threads finish.
+ */
+QGraphViewPrivate::~QGraphViewPrivate()
+{
+    qDeleteAll( m_tileWatchers );
+}
+
+/**
+ * @brief QGraphViewPrivate::isTiledViewport
+ * @param widget - the widget being painted on
+ * @return - whether the widget is the viewport of a QGraphView drawing the static nodes and edges from tiles
+ *
+ * Used by the nodes and edges to skip painting themselves when they are drawn by the tile cache of the view.
+ */
+bool QGraphViewPrivate::isTiledViewport(QWidget *widget)
+{
+    if ( ! widget )
+        return false;
+
+    QGraphView* view = qobject_cast< QGraphView* >( widget->parentWidget() );
+
+    return view && view->viewport() == widget && view->d_func()->isTilingActive();
+}
+
+/**
+ * @brief QGraphViewPrivate::setTiledRendering
+ * @param enabled - whether static nodes and edges are drawn from rasterized tiles
+ */
+void QGraphViewPrivate::setTiledRendering(bool enabled)
+{
+    if ( m_tiledRendering == enabled )
+        return;
+
+    m_tiledRendering = enabled;
+
+    attachScene();
+}
+
+/**
+ * @brief QGraphViewPrivate::setZoomRange
+ * @param minimum - the minimum scale of the view
+ * @param maximum - the maximum scale of the view
+ */
+void QGraphViewPrivate::setZoomRange(qreal minimum, qreal maximum)
+{
+    if ( minimum <= 0.0 || maximum < minimum ) {
+        qWarning() << "WARNING: QGraphView::setZoomRange: invalid zoom range" << minimum << maximum;
+        return;
+    }
+
+    m_minimumZoom = minimum;
+    m_maximumZoom = maximum;
+}
+
+/**
+ * @brief QGraphViewPrivate::zoomBy
+ * @param factor - the factor by which the view is scaled
+ *
+ * Scales the view by the specified factor clamped to the zoom range.  Antialiasing is disabled until zooming stops.
+ */
+void QGraphViewPrivate::zoomBy(qreal factor)
+{
+    Q_Q(QGraphView);
+
+    const qreal zoom = q->zoom();
+    if ( factor <= 0.0 || zoom <= 0.0 )
+        return;
+
+    // limit zoom extents
+    const qreal scale = qBound( m_minimumZoom, zoom * factor, m_maximumZoom ) / zoom;
+    if ( qFuzzyCompare( scale, 1.0 ) )
+        return;
+
+    beginScrolling();
+
+    q->scale( scale, scale );
+}
+
+/**
+ * @brief QGraphViewPrivate::setFastScrolling
+ * @param enabled - whether antialiasing is disabled while scrolling
+ */
+void QGraphViewPrivate::setFastScrolling(bool enabled)
+{
+    if ( ! enabled )
+        endScrolling();
+
+    m_fastScrolling = enabled;
+}
+
+/**
+ * @brief QGraphViewPrivate::beginScrolling
+ *
+ * Disables antialiasing and smooth pixmap transformation until the view has been idle for the scroll idle interval.
+ */
+void QGraphViewPrivate::beginScrolling()
+{
+    Q_Q(QGraphView);
+
+    if ( ! m_fastScrolling )
+        return;
+
+    if ( ! m_scrolling ) {
+        m_scrolling = true;
+        m_idleRenderHints = q->renderHints();
+        q->setRenderHints( m_idleRenderHints & ~( QPainter::Antialiasing | QPainter::SmoothPixmapTransform ) );
+    }
+
+    m_idleTimer->start();
+}
+
+/**
+ * @brief QGraphViewPrivate::endScrolling
+ *
+ * Restores the render hints disabled by beginScrolling() which repaints the viewport.
+ */
+void QGraphViewPrivate::endScrolling()
+{
+    Q_Q(QGraphView);
+
+    if ( ! m_scrolling )
+        return;
+
+    m_scrolling = false;
+    m_idleTimer->stop();
+
+    q->setRenderHints( m_idleRenderHints );
+}
+
+/**
+ * @brief QGraphViewPrivate::isTilingActive
+ * @return - whether tiled rendering is enabled for the scene and the view transform is a uniform scale
+ */
+bool QGraphViewPrivate::isTilingActive() const
+{
+    Q_Q(const QGraphView);
+
+    if ( ! m_tiledRendering || ! m_tileScene )
+        return false;
+
+    const QTransform transform = q->transform();
+
+    return transform.type() <= QTransform::TxScale && transform.m11() > 0.0 && qFuzzyCompare( transform.m11(), transform.m22() );
+}
+
+/**
+ * @brief QGraphViewPrivate::attachScene
+ *
+ * Discards the tiles of the previous scene and tracks the changes of the current scene of the view when tiled
+ * rendering is enabled.
+ */
+void QGraphViewPrivate::attachScene()
+{
+    Q_Q(QGraphView);
+
+    if ( m_tileScene ) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+        QObject::disconnect( m_tileScene.data(), &QGraphicsScene::changed, q, &QGraphView::handleSceneChanged );
+#else
+        QObject::disconnect( m_tileScene, SIGNAL(changed(QList<QRectF>)), q, SLOT(handleSceneChanged(QList<QRectF>)) );
+#endif
+    }
+
+    clearTiles();
+
+    m_tileScene = q->scene();
+
+    if ( m_tileScene && m_tiledRendering ) {
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+        QObject::connect( m_tileScene.data(), &QGraphicsScene::changed, q, &QGraphView::handleSceneChanged );
+#else
+        QObject::connect( m_tileScene, SIGNAL(changed(QList<QRectF>)), q, SLOT(handleSceneChanged(QList<QRectF>)) );
+#endif
+    }
+}
+
+/**
+ * @brief QGraphViewPrivate::clearTiles
+ *
+ * Discards all cached tiles and the results of the tiles being rendered.
+ */
+void QGraphViewPrivate::clearTiles()
+{
+    m_tiles.clear();
+    m_pendingTiles.clear();
+}
+
+/**
+ * @brief QGraphViewPrivate::zoomLevel
+ * @return - the zoom level of the tiles drawn at the current view scale
+ */
+int QGraphViewPrivate::zoomLevel() const
+{
+    Q_Q(const QGraphView);
+
+    return qRound( std::log( q->transform().m11() ) / std::log( 2.0 ) * LEVELS_PER_OCTAVE );
+}
+
+/**
+ * @brief QGraphViewPrivate::levelScale
+ * @param level - the zoom level
+ * @return - the scale at which the tiles of the zoom level are rasterized
+ */
+qreal QGraphViewPrivate::levelScale(int level)
+{
+    return std::pow( 2.0, qreal( level ) / LEVELS_PER_OCTAVE );
+}
+
+/**
+ * @brief QGraphViewPrivate::tileRect
+ * @param key - the tile key
+ * @return - the scene rectangle covered by the tile
+ */
+QRectF QGraphViewPrivate::tileRect(const TileKey &key)
+{
+    const qreal extent = TILE_SIZE / levelScale( key.level );
+
+    return QRectF( key.x * extent, key.y * extent, extent, extent );
+}
+
+/**
+ * @brief QGraphViewPrivate::drawTiles
+ * @param painter - the view painter instance in scene coordinates
+ * @param exposedRect - the exposed rectangle in scene coordinates
+ *
+ * Draws the tiles of the current zoom level covering the exposed part of the scene.  Missing and stale tiles are
+ * requested from the worker threads; until a missing tile has been rendered the cached tiles of the nearest zoom
+ * level are drawn scaled in its place.
+ */
+void QGraphViewPrivate::drawTiles(QPainter *painter, const QRectF &exposedRect)
+{
+    Q_Q(QGraphView);
+
+    const QRectF rect = exposedRect & q->sceneRect();
+    if ( rect.isEmpty() )
+        return;
+
+    const int level = zoomLevel();
+    const qreal extent = TILE_SIZE / levelScale( level );
+
+    const int left = int( std::floor( rect.left() / extent ) );
+    const int right = int( std::floor( rect.right() / extent ) );
+    const int top = int( std::floor( rect.top() / extent ) );
+    const int bottom = int( std::floor( rect.bottom() / extent ) );
+
+    painter->save();
+
+    // the tiles of the current zoom level are drawn scaled by up to an eighth of an octave
+    painter->setRenderHint( QPainter::SmoothPixmapTransform, ! m_scrolling );
+
+    for ( int y = top; y <= bottom; ++y ) {
+        for ( int x = left; x <= right; ++x ) {
+            const TileKey key( level, x, y );
+            Tile* tile = m_tiles.object( key );
+            if ( ! tile || tile->stale )
+                requestTile( key );
+            if ( tile )
+                painter->drawImage( tileRect( key ), tile->image );
+            else
+                drawFallbackTiles( painter, key );
+        }
+    }
+
+    painter->restore();
+}
+
+/**
+ * @brief QGraphViewPrivate::drawFallbackTiles
+ * @param painter - the view painter instance in scene coordinates
+ * @param key - the key of the missing tile
+ *
+ * Draws the parts of the cached tiles of the zoom level nearest to the missing tile which cover the missing tile.
+ */
+void QGraphViewPrivate::drawFallbackTiles(QPainter *painter, const TileKey &key)
+{
+    const QRectF rect = tileRect( key );
+    const QList< TileKey > keys = m_tiles.keys();
+
+    // find the cached zoom level nearest to the zoom level of the missing tile
+    bool found( false );
+    int fallbackLevel( key.level );
+    foreach ( const TileKey& other, keys ) {
+        if ( other.level == key.level || ! tileRect( other ).intersects( rect ) )
+            continue;
+        if ( ! found || qAbs( other.level - key.level ) < qAbs( fallbackLevel - key.level ) ) {
+            fallbackLevel = other.level;
+            found = true;
+        }
+    }
+
+    if ( ! found )
+        return;
+
+    const qreal scale = levelScale( fallbackLevel );
+
+    foreach ( const TileKey& other, keys ) {
+        if ( other.level != fallbackLevel )
+            continue;
+        const QRectF otherRect = tileRect( other );
+        const QRectF target = otherRect & rect;
+        if ( target.isEmpty() )
+            continue;
+        // map the covered part of the missing tile to the pixels of the fallback tile
+        const QRectF source( ( target.topLeft() - otherRect.topLeft() ) * scale, target.size() * scale );
+        painter->drawImage( target, m_tiles.object( other )->image, source );
+    }
+}
+
+/**
+ * @brief QGraphViewPrivate::requestTile
+ * @param key - the tile key
+ *
+ * Copies the states of the static nodes and edges intersecting the tile in stacking order and renders the tile on a
+ * worker thread.  Selected items are excluded as they are painted directly by the view.  Tiles without any static
+ * items are cached right away.
+ */
+void QGraphViewPrivate::requestTile(const TileKey &key)
+{
+    Q_Q(QGraphView);
+
+    if ( ! m_tileScene || m_pendingTiles.contains( key ) )
+        return;
+
+    TileRequest request;
+
+    request.key = key;
+    request.serial = ++m_tileSerial;
+    request.scale = levelScale( key.level );
+    request.rect = tileRect( key );
+    // tiles requested while scrolling are cached and thus rendered with the render hints of the idle view
+    request.renderHints = m_scrolling ? m_idleRenderHints : q->renderHints();
+    request.options = QGraphNodePrivate::paintOptions( m_tileScene );
+
+    // use the static item index of the canvas when enabled instead of the scene index
+    QGraphCanvas* canvas = qobject_cast< QGraphCanvas* >( m_tileScene );
+    const QList< QGraphicsItem* > items = ( canvas && canvas->isStaticItemIndex() ) ?
+                canvas->graphItems( request.rect ) :
+                m_tileScene->items( request.rect, Qt::IntersectsItemBoundingRect, Qt::AscendingOrder );
+
+    foreach ( QGraphicsItem* item, items ) {
+        if ( item->isSelected() || ! item->isVisible() )
+            continue;
+
+        TileItem tileItem;
+        tileItem.transform = item->sceneTransform();
+
+        // the painter paths and label texts are detached so that their lazily computed internals are not shared
+        // between the GUI thread and the worker thread
+        if ( item->type() == QGraphNode::Type ) {
+            QGraphNodePrivate::State state = static_cast< QGraphNode* >( item )->d_func()->state();
+            state.path = detachedPath( state.path );
+            state.labelText = detachedText( state.labelText );
+            tileItem.isNode = true;
+            tileItem.index = request.nodes.size();
+            request.nodes.append( state );
+        }
+        else if ( item->type() == QGraphEdge::Type ) {
+            QGraphEdgePrivate::State state = static_cast< QGraphEdge* >( item )->d_func()->state();
+            state.path = detachedPath( state.path );
+            state.arrowPath = detachedPath( state.arrowPath );
+            state.labelText = detachedText( state.labelText );
+            tileItem.isNode = false;
+            tileItem.index = request.edges.size();
+            request.edges.append( state );
+        }
+        else {
+            continue;
+        }
+
+        request.items.append( tileItem );
+    }
+
+    if ( request.items.isEmpty() ) {
+        m_tiles.insert( key, new Tile, 0 );
+        return;
+    }
+
+    m_pendingTiles.insert( key, request.serial );
+
+    QFutureWatcher< TileResult >* watcher = new QFutureWatcher< TileResult >( q );
+
+    m_tileWatchers.append( watcher );
+
+#if (QT_VERSION >= QT_VERSION_CHECK(5,0,0))
+    QObject::connect( watcher, &QFutureWatcherBase::finished, q, &QGraphView::handleTileRendered );
+#else
+    QObject::connect( watcher, SIGNAL(finished()), q, SLOT(handleTileRendered()) );
+#endif
+
+    watcher->setFuture( QtConcurrent::run( &QGraphViewPrivate::renderTile, request ) );
+}
+
+/**
+ * @brief QGraphViewPrivate::invalidateTiles
+ * @param region - the changed scene rectangles (empty if the whole scene changed)
+ *
+ * Marks the cached tiles of the current zoom level covering the changed region as stale and renders the visible
+ * ones again.  Tiles of other zoom levels covering the changed region are discarded and the results of the tiles
+ * being rendered for the changed region are ignored.
+ */
+void QGraphViewPrivate::invalidateTiles(const QList<QRectF> &region)
+{
+    Q_Q(QGraphView);
+
+    if ( ! m_tiledRendering )
+        return;
+
+    foreach ( const TileKey& key, m_pendingTiles.keys() ) {
+        if ( intersects( tileRect( key ), region ) )
+            m_pendingTiles.remove( key );
+    }
+
+    const int level = zoomLevel();
+    const bool active = isTilingActive();
+    const QRectF visibleRect = q->mapToScene( q->viewport()->rect() ).boundingRect();
+
+    foreach ( const TileKey& key, m_tiles.keys() ) {
+        const QRectF rect = tileRect( key );
+        if ( ! intersects( rect, region ) )
+            continue;
+        if ( key.level != level ) {
+            m_tiles.remove( key );
+            continue;
+        }
+        m_tiles.object( key )->stale = true;
+        // the cached view background is not redrawn for item changes so visible tiles are rendered right away
+        if ( active && rect.intersects( visibleRect ) )
+            requestTile( key );
+    }
+}
+
+/**
+ * @brief QGraphViewPrivate::handleTileRendered
+ * @param watcher - the watcher of the worker thread that rendered the tile
+ *
+ * Caches the tile rendered by the worker thread and repaints the part of the viewport covered by the tile.  The tile
+ * is discarded if it has been invalidated or requested again in the meantime.
+ */
+void QGraphViewPrivate::handleTileRendered(QFutureWatcher< TileResult > *watcher)
+{
+    Q_Q(QGraphView);
+
+    const TileResult result = watcher->result();
+
+    m_tileWatchers.removeOne( watcher );
+    watcher->deleteLater();
+
+    if ( m_pendingTiles.value( result.key, 0 ) != result.serial )
+        return;
+
+    m_pendingTiles.remove( result.key );
+
+    Tile* tile = new Tile;
+    tile->image = result.image;
+    m_tiles.insert( result.key, tile, result.image.bytesPerLine() * result.image.height() / 1024 );
+
+    if ( result.key.level == zoomLevel() ) {
+        q->resetCachedContent();
+        q->viewport()->update( q->mapFromScene( tileRect( result.key ) ).boundingRect() );
+    }
+}
+
+/**
+ * @brief QGraphViewPrivate::renderTile
+ * @param request - the tile rendering request
+ * @return - the rendered tile
+ *
+ * Rasterizes the copied node and edge states into a transparent tile image.  This method does not access the scene
+ * or its items and thus is invoked concurrently from worker threads.
+ */
+QGraphViewPrivate::TileResult QGraphViewPrivate::renderTile(const TileRequest &request)
+{
+    TileResult result;
+
+    result.key = request.key;
+    result.serial = request.serial;
+    result.image = QImage( TILE_SIZE, TILE_SIZE, QImage::Format_ARGB32_Premultiplied );
+    result.image.fill( Qt::transparent );
+
+    QPainter painter( &result.image );
+    painter.setRenderHints( request.renderHints );
+
+    // maps scene coordinates to the pixels of the tile
+    const QTransform tileTransform = QTransform::fromTranslate( -request.rect.left(), -request.rect.top() ) *
+                                     QTransform::fromScale( request.scale, request.scale );
+
+    foreach ( const TileItem& item, request.items ) {
+        painter.setTransform( item.transform * tileTransform );
+        if ( item.isNode )
+            QGraphNodePrivate::paint( &painter, request.nodes.at( item.index ), request.options, false );
+        else
+            QGraphEdgePrivate::paint( &painter, request.edges.at( item.index ), request.options, false );
+    }
+
+    painter.end();
+
+    return result;
+}
+
+/**
+ * @brief QGraphViewPrivate::detachedPath
+ * @param path - the painter path
+ * @return - a copy of the painter path not sharing its data with the original path
+ */
+QPainterPath QGraphViewPrivate::detachedPath(const QPainterPath &path)
+{
+    QPainterPath detached;
+
+    detached.addPath( path );
+    detached.setFillRule( path.fillRule() );
+
+    return detached;
+}
+
+/**
+ * @brief QGraphViewPrivate::detachedText
+ * @param text - the static text
+ * @return - a copy of the static text not sharing its laid out glyphs with the original static text
+ */
+QStaticText QGraphViewPrivate::detachedText(const QStaticText &text)
+{
+    if ( text.text().isEmpty() )
+        return text;
+
+    QStaticText detached( text.text() );
+
+    detached.setTextFormat( text.textFormat() );
+    detached.setTextWidth( text.textWidth() );
+    detached.setTextOption( text.textOption() );
+
+    return detached;
+}
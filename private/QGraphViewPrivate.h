@@ -0,0 +1,163 @@
+/*!
+   \file QGraphViewPrivate.h
+   \author Gregory Schultz <gregory.schultz@embarqmail.com>
+
+   \section LICENSE
+   This file is part of the Open|SpeedShop Graphical User Interface
+   Copyright (C) 2010-2017 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#ifndef QGRAPHVIEWPRIVATE_H
+#define QGRAPHVIEWPRIVATE_H
+
+#include "QGraphView.h"
+#include "QGraphNodePrivate.h"
+#include "QGraphEdgePrivate.h"
+
+#include <QCache>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QImage>
+#include <QPainter>
+#include <QPointer>
+#include <QTransform>
+#include <QVector>
+
+class QTimer;
+
+
+class QGraphViewPrivate
+{
+    Q_DECLARE_PUBLIC(QGraphView)
+
+public:
+
+    explicit QGraphViewPrivate(QGraphView* parent);
+    ~QGraphViewPrivate();
+
+    // tile of the static scene content keyed by zoom level and tile coordinates in device pixels of that zoom level
+    struct TileKey {
+        TileKey() : level( 0 ), x( 0 ), y( 0 ) { }
+        TileKey(int level, int x, int y) : level( level ), x( x ), y( y ) { }
+        bool operator==(const TileKey& other) const { return level == other.level && x == other.x && y == other.y; }
+        int level;
+        int x;
+        int y;
+    };
+
+    // static node or edge copied on the GUI thread and drawn into a tile by a worker thread
+    struct TileItem {
+        TileItem() : isNode( false ), index( 0 ) { }
+        bool isNode;
+        int index;
+        QTransform transform;
+    };
+
+    // tile rendering request processed by a worker thread
+    struct TileRequest {
+        TileRequest() : serial( 0 ), scale( 1.0 ) { }
+        TileKey key;
+        quint64 serial;
+        qreal scale;
+        QRectF rect;
+        QPainter::RenderHints renderHints;
+        QGraphNodePrivate::PaintOptions options;
+        QVector< QGraphNodePrivate::State > nodes;
+        QVector< QGraphEdgePrivate::State > edges;
+        QVector< TileItem > items;
+    };
+
+    // tile image rendered by a worker thread
+    struct TileResult {
+        TileResult() : serial( 0 ) { }
+        TileKey key;
+        quint64 serial;
+        QImage image;
+    };
+
+    static bool isTiledViewport(QWidget* widget);
+
+private:
+
+    // rasterized tile, stale tiles are drawn until their replacement has been rendered
+    struct Tile {
+        Tile() : stale( false ) { }
+        QImage image;
+        bool stale;
+    };
+
+    void setTiledRendering(bool enabled);
+    bool isTiledRendering() const { return m_tiledRendering; }
+
+    void setTileCacheLimit(int kilobytes) { m_tiles.setMaxCost( kilobytes ); }
+    int tileCacheLimit() const { return m_tiles.maxCost(); }
+
+    void setZoomRange(qreal minimum, qreal maximum);
+    qreal minimumZoom() const { return m_minimumZoom; }
+    qreal maximumZoom() const { return m_maximumZoom; }
+    void zoomBy(qreal factor);
+
+    void setFastScrolling(bool enabled);
+    bool isFastScrolling() const { return m_fastScrolling; }
+    void beginScrolling();
+    void endScrolling();
+
+    bool isTilingActive() const;
+    void attachScene();
+    void clearTiles();
+
+    int zoomLevel() const;
+    static qreal levelScale(int level);
+    static QRectF tileRect(const TileKey& key);
+
+    void drawTiles(QPainter* painter, const QRectF& exposedRect);
+    void drawFallbackTiles(QPainter* painter, const TileKey& key);
+    void requestTile(const TileKey& key);
+    void invalidateTiles(const QList<QRectF>& region);
+    void handleTileRendered(QFutureWatcher< TileResult >* watcher);
+
+    static TileResult renderTile(const TileRequest& request);
+    static QPainterPath detachedPath(const QPainterPath& path);
+    static QStaticText detachedText(const QStaticText& text);
+
+private:
+
+    QGraphView* const q_ptr;
+
+    bool m_tiledRendering;
+    QPointer< QGraphicsScene > m_tileScene;
+    QCache< TileKey, Tile > m_tiles;
+    QHash< TileKey, quint64 > m_pendingTiles;
+    QList< QFutureWatcher< TileResult >* > m_tileWatchers;
+    quint64 m_tileSerial;
+
+    qreal m_minimumZoom;
+    qreal m_maximumZoom;
+
+    bool m_fastScrolling;
+    bool m_scrolling;
+    QPainter::RenderHints m_idleRenderHints;
+    QTimer* m_idleTimer;
+
+};
+
+inline uint qHash(const QGraphViewPrivate::TileKey& key)
+{
+    return uint( key.level ) * 2654435761U ^ uint( key.x ) * 40503U ^ uint( key.y );
+}
+
+#endif // QGRAPHVIEWPRIVATE_H
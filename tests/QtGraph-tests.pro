@@ -0,0 +1,31 @@
+#-------------------------------------------------
+#
+# QtGraph library regression tests and benchmarks
+#
+#-------------------------------------------------
+
+QT       += core gui testlib
+
+greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
+
+TARGET = tst_QGraphCanvas
+TEMPLATE = app
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+INSTALL_ROOT = $$(INSTALL_ROOT)
+GRAPHVIZ_ROOT = $$(GRAPHVIZ_ROOT)
+
+INCLUDEPATH += $$GRAPHVIZ_ROOT/include/graphviz
+LIBS += -L$$GRAPHVIZ_ROOT/lib -lcdt -lgvc -lcgraph
+
+INCLUDEPATH += $$INSTALL_ROOT/include $$INSTALL_ROOT/include/QtGraph
+CONFIG(debug, debug|release) {
+LIBS += -L$$INSTALL_ROOT/lib64/$$QT_VERSION -lQtGraphd
+}
+CONFIG(release, debug|release) {
+LIBS += -L$$INSTALL_ROOT/lib64/$$QT_VERSION -lQtGraph
+}
+
+SOURCES += tst_QGraphCanvas.cpp
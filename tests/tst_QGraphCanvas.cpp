@@ -0,0 +1,592 @@
+/*!
+   \file tst_QGraphCanvas.cpp
+   \author Gregory Schultz <gregory.schultz@embarqmail.com>
+
+   \section LICENSE
+   This file is part of the Open|SpeedShop Graphical User Interface
+   Copyright (C) 2010-2017 Argo Navis Technologies, LLC
+
+   This library is free software; you can redistribute it and/or modify it
+   under the terms of the GNU Lesser General Public License as published by the
+   Free Software Foundation; either version 2.1 of the License, or (at your
+   option) any later version.
+
+   This library is distributed in the hope that it will be useful, but WITHOUT
+   ANY WARRANTY; without even the implied warranty of MERCHANTABILITY or
+   FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser General Public License
+   for more details.
+
+   You should have received a copy of the GNU Lesser General Public License
+   along with this library; if not, write to the Free Software Foundation,
+   Inc., 51 Franklin Street, Fifth Floor, Boston, MA  02110-1301  USA
+ */
+
+#include <QtTest>
+
+#include <QBuffer>
+#include <QDir>
+#include <QFile>
+#include <QGraphicsColorizeEffect>
+#include <QGraphicsItem>
+#include <QImage>
+#include <QMap>
+#include <QPainter>
+#include <QPainterPath>
+#include <QSignalSpy>
+#include <QVector>
+
+#include "QtGraph/QGraphCanvas.h"
+#include "QtGraph/QGraphNode.h"
+#include "QtGraph/QGraphEdge.h"
+
+#if defined(Q_OS_UNIX)
+#include <unistd.h>
+#endif
+
+
+class TestQGraphCanvas : public QObject
+{
+    Q_OBJECT
+
+private slots:
+
+    void cleanupTestCase();
+
+    void constructFromDot();
+
+    void graphItemIndex();
+
+    void reloadAndClear();
+
+    void incrementalLayout();
+
+    void asyncLayout();
+
+    void layoutCache();
+
+    void supersedeLoad();
+
+    void massSelection_data();
+    void massSelection();
+
+    void hitTest_data();
+    void hitTest();
+
+private:
+
+    QGraphCanvas* laidOutCanvas(int nodeCount);
+
+    static QByteArray treeGraph(int nodeCount);
+    static int countItems(const QGraphCanvas& canvas, int type);
+    static qint64 residentMemory();
+
+    QMap< int, QGraphCanvas* > m_canvases;
+
+};
+
+/**
+ * @brief TestQGraphCanvas::cleanupTestCase
+ *
+ * Destroys the canvases shared by the benchmarks.
+ */
+void TestQGraphCanvas::cleanupTestCase()
+{
+    qDeleteAll( m_canvases );
+    m_canvases.clear();
+}
+
+/**
+ * @brief TestQGraphCanvas::laidOutCanvas
+ * @param nodeCount - the number of nodes of the graph
+ * @return - a canvas holding a laid out binary tree with the specified number of nodes
+ *
+ * The canvases are built once and shared by the benchmarks as laying out the large graphs takes much longer than
+ * the operations measured.  The "sfdp" engine is used since it scales to the largest graphs.
+ */
+QGraphCanvas* TestQGraphCanvas::laidOutCanvas(int nodeCount)
+{
+    if ( m_canvases.contains( nodeCount ) )
+        return m_canvases.value( nodeCount );
+
+    QGraphCanvas* canvas = new QGraphCanvas( QStringLiteral("G") );
+
+    canvas->reload( treeGraph( nodeCount ) );
+    canvas->setLayoutEngine( QGraphCanvas::SfdpEngine );
+    canvas->updateLayout();
+
+    m_canvases.insert( nodeCount, canvas );
+
+    return canvas;
+}
+
+/**
+ * @brief TestQGraphCanvas::treeGraph
+ * @param nodeCount - the number of nodes of the graph
+ * @return - a DOT formatted binary tree with the specified number of nodes
+ */
+QByteArray TestQGraphCanvas::treeGraph(int nodeCount)
+{
+    QByteArray data( "digraph G {\n" );
+
+    data += "n0;\n";
+    for ( int i=1; i<nodeCount; i++ ) {
+        data += "n" + QByteArray::number( ( i - 1 ) / 2 ) + " -> n" + QByteArray::number( i ) + ";\n";
+    }
+
+    data += "}\n";
+
+    return data;
+}
+
+/**
+ * @brief TestQGraphCanvas::countItems
+ * @param canvas - the graph canvas
+ * @param type - the item type (QGraphNode::Type or QGraphEdge::Type)
+ * @return - the number of items of the canvas with the specified type
+ */
+int TestQGraphCanvas::countItems(const QGraphCanvas &canvas, int type)
+{
+    int count( 0 );
+
+    foreach( QGraphicsItem* item, canvas.items() ) {
+        if ( item->type() == type )
+            count++;
+    }
+
+    return count;
+}
+
+/**
+ * @brief TestQGraphCanvas::residentMemory
+ * @return - the resident set size of the process in bytes (-1 if unknown)
+ */
+qint64 TestQGraphCanvas::residentMemory()
+{
+#if defined(Q_OS_UNIX)
+    QFile file( QStringLiteral("/proc/self/statm") );
+
+    if ( ! file.open( QIODevice::ReadOnly ) )
+        return -1;
+
+    // the second field is the number of resident pages
+    const QList< QByteArray > fields = file.readAll().simplified().split( ' ' );
+
+    if ( fields.size() < 2 )
+        return -1;
+
+    return fields.at( 1 ).toLongLong() * sysconf( _SC_PAGESIZE );
+#else
+    return -1;
+#endif
+}
+
+/**
+ * @brief TestQGraphCanvas::constructFromDot
+ *
+ * The canvases built from DOT text and from a device create the graph items in their constructors, while the items
+ * notify the canvas of their scene changes.
+ */
+void TestQGraphCanvas::constructFromDot()
+{
+    const int nodeCount( 32 );
+    const QByteArray data = treeGraph( nodeCount );
+
+    {
+        QGraphCanvas canvas( data.constData() );
+        QCOMPARE( countItems( canvas, QGraphNode::Type ), nodeCount );
+        QCOMPARE( countItems( canvas, QGraphEdge::Type ), nodeCount - 1 );
+
+        // the static item index must have been kept consistent with the items added during construction
+        canvas.setStaticItemIndex( true );
+        canvas.updateLayout();
+        QCOMPARE( canvas.graphItems( canvas.itemsBoundingRect() ).size(), 2 * nodeCount - 1 );
+    }
+
+    {
+        QBuffer buffer;
+        buffer.setData( data );
+
+        QGraphCanvas canvas( &buffer );
+        QCOMPARE( countItems( canvas, QGraphNode::Type ), nodeCount );
+        QCOMPARE( countItems( canvas, QGraphEdge::Type ), nodeCount - 1 );
+    }
+}
+
+/**
+ * @brief TestQGraphCanvas::graphItemIndex
+ *
+ * Looks up nodes by name and parallel edges by their end nodes.  A second node instance for a node which already has
+ * one on the canvas must be rejected and leave the indexed instance in place.
+ */
+void TestQGraphCanvas::graphItemIndex()
+{
+    QGraphCanvas canvas( "digraph G { a -> b; a -> b; a -> b [label=x]; a -> c; c -> b; }" );
+
+    QGraphNode* a = canvas.graphNode( QStringLiteral("a") );
+    QGraphNode* b = canvas.graphNode( QStringLiteral("b") );
+    QVERIFY( a != Q_NULLPTR );
+    QVERIFY( b != Q_NULLPTR );
+
+    QCOMPARE( canvas.graphEdges( a, b ).size(), 3 );
+    QCOMPARE( canvas.graphEdges( QStringLiteral("a"), QStringLiteral("c") ).size(), 1 );
+    QCOMPARE( canvas.graphEdges( QStringLiteral("c"), QStringLiteral("b") ).size(), 1 );
+    QVERIFY( canvas.graphEdges( b, a ).isEmpty() );
+
+    QGraphNode* duplicate = new QGraphNode( QStringLiteral("a"), &canvas );
+    canvas.addGraphNode( duplicate );
+    QVERIFY( duplicate->scene() == Q_NULLPTR );
+    QCOMPARE( canvas.graphNode( QStringLiteral("a") ), a );
+    QCOMPARE( countItems( canvas, QGraphNode::Type ), 3 );
+    delete duplicate;
+
+    // the layout must find every parallel edge by its key
+    canvas.updateLayout();
+    foreach ( QGraphEdge* edge, canvas.graphEdges( a, b ) ) {
+        QVERIFY( ! edge->boundingRect().isEmpty() );
+    }
+}
+
+/**
+ * @brief TestQGraphCanvas::reloadAndClear
+ *
+ * Opens and closes 1,000 graphs with the same canvas.  After each reload the canvas must hold exactly the items of the
+ * graph and after each clear none at all.  As the graph, its layout and its items are freed every time, the resident
+ * memory must not grow with the number of graphs once the allocator caches are warm.
+ */
+void TestQGraphCanvas::reloadAndClear()
+{
+    const int nodeCount( 32 );
+    const QByteArray data = treeGraph( nodeCount );
+
+    QGraphCanvas canvas( QStringLiteral("G") );
+
+    const int baselineItems = canvas.items().size();
+
+    // warm up the allocator and the Graphviz plugin caches before the memory baseline is taken
+    for ( int i=0; i<50; i++ ) {
+        QVERIFY( canvas.reload( data ) );
+        canvas.updateLayout();
+        canvas.updateLayout();
+        canvas.clearGraph();
+    }
+
+    const qint64 baselineMemory = residentMemory();
+
+    for ( int i=0; i<1000; i++ ) {
+        QVERIFY( canvas.reload( data ) );
+        QCOMPARE( countItems( canvas, QGraphNode::Type ), nodeCount );
+        QCOMPARE( countItems( canvas, QGraphEdge::Type ), nodeCount - 1 );
+
+        // a second layout of the same graph must free the first one
+        canvas.updateLayout();
+        canvas.updateLayout();
+
+        canvas.clearGraph();
+        QCOMPARE( canvas.items().size(), baselineItems );
+    }
+
+    if ( baselineMemory < 0 )
+        return;
+
+    const qint64 growth = residentMemory() - baselineMemory;
+
+    QVERIFY2( growth < 4 * 1024 * 1024, qPrintable( QStringLiteral("the resident memory grew by %1 bytes").arg( growth ) ) );
+}
+
+/**
+ * @brief TestQGraphCanvas::incrementalLayout
+ *
+ * A node without edges added after the layout has no laid out neighbors to be placed near, so the incremental layout
+ * must place it inside or next to the bounding box of the laid out graph rather than anywhere in the scene.
+ */
+void TestQGraphCanvas::incrementalLayout()
+{
+    QGraphCanvas canvas( treeGraph( 16 ).constData() );
+    canvas.updateLayout();
+
+    const QRectF boundingBox = canvas.itemsBoundingRect();
+    const QPointF root = canvas.graphNode( QStringLiteral("n0") )->pos();
+
+    QGraphNode* node = new QGraphNode( QStringLiteral("x"), &canvas );
+    canvas.addGraphNode( node );
+    canvas.updateLayoutIncremental();
+
+    // the laid out nodes are pinned
+    QCOMPARE( canvas.graphNode( QStringLiteral("n0") )->pos(), root );
+
+    // within a few node spacings of the laid out graph
+    const qreal margin( 3 * 72.0 );
+    QVERIFY2( boundingBox.adjusted( -margin, -margin, margin, margin ).contains( node->pos() ),
+              qPrintable( QStringLiteral("the node at %1,%2 is far from the bounding box %3,%4 %5x%6")
+                          .arg( node->pos().x() ).arg( node->pos().y() )
+                          .arg( boundingBox.x() ).arg( boundingBox.y() ).arg( boundingBox.width() ).arg( boundingBox.height() ) ) );
+    QVERIFY( ! node->sceneBoundingRect().isEmpty() );
+}
+
+/**
+ * @brief TestQGraphCanvas::asyncLayout
+ *
+ * The asynchronous layout lays out a snapshot of the graph taken without the Graphviz library, so a superseded request
+ * must not be applied and the layout of the snapshot must match the synchronous layout of the graph itself.
+ */
+void TestQGraphCanvas::asyncLayout()
+{
+    const QByteArray data( "digraph G {\n"
+                           "node [shape=box];\n"
+                           "subgraph cluster_a { label=\"a\"; a0 -> a1; a0 -> a2; }\n"
+                           "subgraph cluster_b { b0 [shape=ellipse]; b0 -> b1 [label=\"b\"]; }\n"
+                           "a1 -> b0; a2 -> b0; a2 -> b0; b1 -> a0 [weight=2];\n"
+                           "}\n" );
+
+    QGraphCanvas canvas( data.constData() );
+
+    canvas.updateLayout();
+
+    const QStringList names = QStringList() << "a0" << "a1" << "a2" << "b0" << "b1";
+
+    QHash< QString, QPointF > positions;
+    foreach( const QString& name, names ) {
+        QGraphNode* node = canvas.graphNode( name );
+        QVERIFY( node );
+        positions.insert( name, node->pos() );
+    }
+
+    foreach( QGraphicsItem* item, canvas.items() ) {
+        item->setPos( QPointF() );
+    }
+
+    QSignalSpy spy( &canvas, SIGNAL(layoutUpdated()) );
+
+    canvas.updateLayoutAsync();
+    canvas.updateLayoutAsync();
+
+    for ( int i=0; i<1000 && spy.count() == 0; i++ ) {
+        QTest::qWait( 10 );
+    }
+
+    // give a superseded layout the chance to be applied wrongly
+    QTest::qWait( 100 );
+
+    QCOMPARE( spy.count(), 1 );
+
+    foreach( const QString& name, names ) {
+        QCOMPARE( canvas.graphNode( name )->pos(), positions.value( name ) );
+    }
+}
+
+/**
+ * @brief TestQGraphCanvas::layoutCache
+ *
+ * Laying out the same graph again, synchronously or asynchronously, must find the layout cached by the first layout
+ * rather than cache it under a new key.
+ */
+void TestQGraphCanvas::layoutCache()
+{
+    QDir cacheDirectory( QDir::temp().filePath( QStringLiteral("tst_QGraphCanvas-%1").arg( QCoreApplication::applicationPid() ) ) );
+
+    QGraphCanvas canvas( treeGraph( 32 ).constData() );
+    canvas.setLayoutCacheDirectory( cacheDirectory.absolutePath() );
+
+    canvas.updateLayout();
+    canvas.updateLayout();
+
+    QSignalSpy spy( &canvas, SIGNAL(layoutUpdated()) );
+
+    canvas.updateLayoutAsync();
+
+    for ( int i=0; i<1000 && spy.count() == 0; i++ ) {
+        QTest::qWait( 10 );
+    }
+
+    const QStringList cacheFiles = cacheDirectory.entryList( QDir::Files );
+
+    foreach( const QString& cacheFile, cacheFiles ) {
+        cacheDirectory.remove( cacheFile );
+    }
+    QDir::temp().rmdir( cacheDirectory.dirName() );
+
+    QCOMPARE( spy.count(), 1 );
+    QCOMPARE( cacheFiles.size(), 1 );
+    QVERIFY( cacheFiles.first().endsWith( QStringLiteral(".layout") ) );
+}
+
+/**
+ * @brief TestQGraphCanvas::supersedeLoad
+ *
+ * Superseding a load while its items are being created must not leave the partly itemized graph behind, even when
+ * the superseding load fails.
+ */
+void TestQGraphCanvas::supersedeLoad()
+{
+    const int nodeCount( 50000 );
+
+    QGraphCanvas canvas( QStringLiteral("G") );
+
+    QSignalSpy progressSpy( &canvas, SIGNAL(loadProgress(int,int)) );
+    QSignalSpy finishedSpy( &canvas, SIGNAL(loadFinished(bool)) );
+
+    canvas.loadGraphAsync( treeGraph( nodeCount ) );
+
+    // wait for the first time slice of item creation
+    bool creatingItems( false );
+    for ( int i=0; i<6000 && ! creatingItems && finishedSpy.isEmpty(); i++ ) {
+        QTest::qWait( 10 );
+        for ( int j=0; j<progressSpy.size(); j++ ) {
+            const int value = progressSpy.at( j ).at( 0 ).toInt();
+            if ( value > 0 && value < nodeCount )
+                creatingItems = true;
+        }
+    }
+
+    QVERIFY( creatingItems );
+    QVERIFY( finishedSpy.isEmpty() );
+    QVERIFY( countItems( canvas, QGraphNode::Type ) > 0 );
+
+    // the superseding load fails to parse
+    canvas.loadGraphAsync( QByteArray( "digraph G { a -> " ) );
+
+    QCOMPARE( countItems( canvas, QGraphNode::Type ) + countItems( canvas, QGraphEdge::Type ), 0 );
+
+    for ( int i=0; i<1000 && finishedSpy.isEmpty(); i++ ) {
+        QTest::qWait( 10 );
+    }
+
+    QCOMPARE( finishedSpy.size(), 1 );
+    QCOMPARE( finishedSpy.at( 0 ).at( 0 ).toBool(), false );
+    QCOMPARE( countItems( canvas, QGraphNode::Type ) + countItems( canvas, QGraphEdge::Type ), 0 );
+}
+
+/**
+ * @brief TestQGraphCanvas::massSelection_data
+ *
+ * Compares the selection highlight drawn at paint time with the QGraphicsColorizeEffect formerly installed on each
+ * selected node and edge.
+ */
+void TestQGraphCanvas::massSelection_data()
+{
+    QTest::addColumn< bool >( "colorizeEffect" );
+
+    QTest::newRow( "paint highlight" ) << false;
+    QTest::newRow( "colorize effect" ) << true;
+}
+
+/**
+ * @brief TestQGraphCanvas::massSelection
+ *
+ * Measures rubber-band selecting all 2,000 nodes and their edges, painting the selection and clearing it.
+ */
+void TestQGraphCanvas::massSelection()
+{
+    QFETCH( bool, colorizeEffect );
+
+    QGraphCanvas* canvas = laidOutCanvas( 2000 );
+
+    QCOMPARE( countItems( *canvas, QGraphNode::Type ), 2000 );
+
+    QPainterPath area;
+    area.addRect( canvas->itemsBoundingRect() );
+
+    QImage image( 1024, 1024, QImage::Format_ARGB32_Premultiplied );
+
+    QBENCHMARK {
+        canvas->setSelectionArea( area );
+
+        const QList< QGraphicsItem* > selectedItems = canvas->selectedItems();
+
+        // as done on selection by QGraphNode::itemChange() and QGraphEdge::itemChange() before the paint-time highlight
+        if ( colorizeEffect ) {
+            foreach( QGraphicsItem* item, selectedItems ) {
+                item->setGraphicsEffect( new QGraphicsColorizeEffect );
+            }
+        }
+
+        image.fill( Qt::white );
+        QPainter painter( &image );
+        canvas->render( &painter );
+        painter.end();
+
+        if ( colorizeEffect ) {
+            foreach( QGraphicsItem* item, selectedItems ) {
+                item->setGraphicsEffect( 0 );
+            }
+        }
+
+        canvas->clearSelection();
+    }
+}
+
+/**
+ * @brief TestQGraphCanvas::hitTest_data
+ *
+ * Graphs of 10k and 100k items (a binary tree of N nodes has 2N-1 nodes and edges) are queried with and without the
+ * static item index, by point with graphItemAt() and by rectangle with graphItems().
+ */
+void TestQGraphCanvas::hitTest_data()
+{
+    QTest::addColumn< int >( "nodeCount" );
+    QTest::addColumn< bool >( "staticItemIndex" );
+    QTest::addColumn< bool >( "rectQuery" );
+
+    QTest::newRow( "10k items, scene index, point" ) << 5000 << false << false;
+    QTest::newRow( "10k items, static index, point" ) << 5000 << true << false;
+    QTest::newRow( "10k items, scene index, rect" ) << 5000 << false << true;
+    QTest::newRow( "10k items, static index, rect" ) << 5000 << true << true;
+    QTest::newRow( "100k items, scene index, point" ) << 50000 << false << false;
+    QTest::newRow( "100k items, static index, point" ) << 50000 << true << false;
+    QTest::newRow( "100k items, scene index, rect" ) << 50000 << false << true;
+    QTest::newRow( "100k items, static index, rect" ) << 50000 << true << true;
+}
+
+/**
+ * @brief TestQGraphCanvas::hitTest
+ *
+ * Measures the latency of 1,000 hit tests at pseudo-random positions spread over the graph.  The rectangles are the
+ * size of a mouse cursor neighborhood as used for hovering and rubber-band selection.
+ */
+void TestQGraphCanvas::hitTest()
+{
+    QFETCH( int, nodeCount );
+    QFETCH( bool, staticItemIndex );
+    QFETCH( bool, rectQuery );
+
+    QGraphCanvas* canvas = laidOutCanvas( nodeCount );
+
+    QCOMPARE( countItems( *canvas, QGraphNode::Type ) + countItems( *canvas, QGraphEdge::Type ), 2 * nodeCount - 1 );
+
+    canvas->setStaticItemIndex( staticItemIndex );
+
+    const QRectF bounds = canvas->itemsBoundingRect();
+
+    // the same positions for every row
+    qsrand( 1 );
+
+    QVector< QPointF > positions( 1000 );
+    for ( int i=0; i<positions.size(); i++ ) {
+        positions[i] = QPointF( bounds.left() + bounds.width() * qrand() / RAND_MAX,
+                                bounds.top() + bounds.height() * qrand() / RAND_MAX );
+    }
+
+    // the static item index is built by the first query
+    canvas->graphItemAt( bounds.center() );
+
+    int hits( 0 );
+
+    QBENCHMARK {
+        hits = 0;
+        foreach( const QPointF& pos, positions ) {
+            if ( rectQuery )
+                hits += canvas->graphItems( QRectF( pos - QPointF( 8.0, 8.0 ), QSizeF( 16.0, 16.0 ) ) ).size();
+            else if ( canvas->graphItemAt( pos ) )
+                hits++;
+        }
+    }
+
+    canvas->setStaticItemIndex( false );
+
+    QVERIFY( hits > 0 );
+}
+
+
+QTEST_MAIN(TestQGraphCanvas)
+
+#include "tst_QGraphCanvas.moc"